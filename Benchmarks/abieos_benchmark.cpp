@@ -0,0 +1,289 @@
+// Measures the abieos C API on the ABIs bundled with EosioSwiftAbieosSerializationProvider and a small corpus of
+// representative payloads. Every operation is timed call by call; the report gives ops/s, input bytes/s and the p50
+// and p99 latency of a single call.
+//
+// Build:
+//    cc -O3 -c Sources/Abieos/eosio/fpconv.c -o fpconv.o
+//    c++ -std=gnu++17 -O3 -I Sources/Abieos -I Sources/Abieos/include Benchmarks/abieos_benchmark.cpp Sources/Abieos/abi.cpp Sources/Abieos/abieos.cpp Sources/Abieos/crypto.cpp fpconv.o -o abieos_benchmark -pthread
+//
+// Usage:
+//    abieos_benchmark [--abi-dir <dir>] [--min-time <seconds>] [--filter <substring>] [--seed <n>] [--json <file>|-]
+//
+// --abi-dir defaults to Sources/EosioSwiftAbieosSerializationProvider. The random_* payloads come from
+// abieos_random_bin with --seed (default 1). --json writes the results as a JSON array of
+// {"name", "op", "ops", "ops_per_sec", "bytes_per_sec", "p50_ns", "p99_ns"} objects, which is stable from run to run
+// and suitable for regression tracking.
+
+#include <abieos.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char token_abi[] =
+    R"({"version":"eosio::abi/1.0","types":[{"new_type_name":"account_name","type":"name"}],"structs":[)"
+    R"({"name":"transfer","base":"","fields":[{"name":"from","type":"account_name"},{"name":"to","type":"account_name"},)"
+    R"({"name":"quantity","type":"asset"},{"name":"memo","type":"string"}]},)"
+    R"({"name":"create","base":"","fields":[{"name":"issuer","type":"account_name"},{"name":"maximum_supply","type":"asset"}]},)"
+    R"({"name":"issue","base":"","fields":[{"name":"to","type":"account_name"},{"name":"quantity","type":"asset"},)"
+    R"({"name":"memo","type":"string"}]},{"name":"account","base":"","fields":[{"name":"balance","type":"asset"}]},)"
+    R"({"name":"currency_stats","base":"","fields":[{"name":"supply","type":"asset"},{"name":"max_supply","type":"asset"},)"
+    R"({"name":"issuer","type":"account_name"}]}],"actions":[{"name":"transfer","type":"transfer","ricardian_contract":""},)"
+    R"({"name":"issue","type":"issue","ricardian_contract":""},{"name":"create","type":"create","ricardian_contract":""}],)"
+    R"("tables":[{"name":"accounts","index_type":"i64","key_names":["currency"],"key_types":["uint64"],"type":"account"},)"
+    R"({"name":"stat","index_type":"i64","key_names":["currency"],"key_types":["uint64"],"type":"currency_stats"}],)"
+    R"("ricardian_clauses":[],"error_messages":[],"variants":[]})";
+
+struct abi_source {
+    const char* contract;
+    const char* file; // relative to --abi-dir; null for embedded
+    const char* json;
+};
+
+const abi_source abis[] = {
+    {"transaction", "transaction.abi.json", nullptr},
+    {"eosio.assert", "eosio.assert.abi.json", nullptr},
+    {"eosio.token", nullptr, token_abi},
+};
+
+struct payload {
+    const char* name;
+    const char* contract;
+    const char* type;
+    std::string json;
+};
+
+std::string transaction_json(int num_actions) {
+    std::string actions;
+    for (int i = 0; i < num_actions; ++i) {
+        if (i)
+            actions += ',';
+        actions += R"({"account":"eosio.token","name":"transfer","authorization":[{"actor":"cryptkeeper","permission":)"
+                   R"("active"}],"data":"00AEAA4AC15CFD4500000060D234CD3DA06806000000000004454F53000000001A746865206772)"
+                   R"(617373686F70706572206C696573206865617679"})";
+    }
+    return R"({"expiration":"2019-02-26T18:31:50.000","ref_block_num":40361,"ref_block_prefix":306112488,)"
+           R"("max_net_usage_words":0,"max_cpu_usage_ms":0,"delay_sec":0,"context_free_actions":[],"actions":[)" +
+           actions + R"(],"transaction_extensions":[]})";
+}
+
+std::string require_json(int num_actions) {
+    std::string hash = "\"0000000000000000000000000000000000000000000000000000000000000000\"";
+    std::string actions, hashes;
+    for (int i = 0; i < num_actions; ++i) {
+        actions += std::string(i ? "," : "") + R"({"contract":"eosio.token","action":"transfer"})";
+        hashes += (i ? "," : "") + hash;
+    }
+    return R"({"chain_params_hash":)" + hash + R"(,"manifest_id":)" + hash + R"(,"actions":[)" + actions +
+           R"(],"abi_hashes":[)" + hashes + "]}";
+}
+
+std::vector<payload> make_payloads() {
+    return {
+        {"transaction_1", "transaction", "transaction", transaction_json(1)},
+        {"transaction_20", "transaction", "transaction", transaction_json(20)},
+        {"transfer", "eosio.token", "transfer",
+         R"({"from":"useraaaaaaaa","to":"useraaaaaaab","quantity":"0.0001 SYS","memo":"the grasshopper lies heavy"})"},
+        {"currency_stats", "eosio.token", "currency_stats",
+         R"({"supply":"1000000000.0000 SYS","max_supply":"10000000000.0000 SYS","issuer":"eosio"})"},
+        {"require", "eosio.assert", "require", require_json(4)},
+        {"add.manifest", "eosio.assert", "manifest",
+         R"({"account":"eosio.assert","domain":"https://example.com","appmeta":"https://example.com/app-metadata.json",)"
+         R"("whitelist":[{"contract":"eosio.token","action":"transfer"},{"contract":"eosio","action":"buyram"}]})"},
+    };
+}
+
+// Generated with abieos_random_bin
+const payload random_payloads[] = {
+    {"random_transaction", "transaction", "transaction", {}},
+    {"random_require", "eosio.assert", "require", {}},
+    {"random_manifest", "eosio.assert", "manifest", {}},
+};
+
+// One names op converts all of these
+const char* const names[] = {"eosio", "eosio.token", "useraaaaaaaa", "cryptkeeper", "a.b.c.d.e.f", "zzzzzzzzzzzzj"};
+
+struct result {
+    std::string name;
+    std::string op;
+    size_t ops = 0;
+    double ops_per_sec = 0;
+    double bytes_per_sec = 0;
+    double p50_ns = 0;
+    double p99_ns = 0;
+};
+
+struct benchmark {
+    double min_time = 0.5;
+    std::string filter;
+    std::vector<result> results;
+
+    // Calls f (which returns false on failure) until min_time has passed. bytes is the input size of one call.
+    template <typename F>
+    void run(const std::string& name, const char* op, size_t bytes, F f) {
+        if (!filter.empty() && (name + "/" + op).find(filter) == std::string::npos)
+            return;
+        using clock = std::chrono::steady_clock;
+        for (int i = 0; i < 10; ++i) // warm up
+            if (!f())
+                throw std::runtime_error(name + "/" + op + " failed");
+        std::vector<double> latencies;
+        auto start = clock::now();
+        auto end = start + std::chrono::duration<double>(min_time);
+        auto now = start;
+        while (now < end || latencies.size() < 100) {
+            auto before = now;
+            if (!f())
+                throw std::runtime_error(name + "/" + op + " failed");
+            now = clock::now();
+            latencies.push_back(std::chrono::duration<double, std::nano>(now - before).count());
+        }
+        std::chrono::duration<double> elapsed = now - start;
+        std::sort(latencies.begin(), latencies.end());
+        result r{name, op, latencies.size()};
+        r.ops_per_sec = r.ops / elapsed.count();
+        r.bytes_per_sec = r.ops_per_sec * bytes;
+        r.p50_ns = latencies[latencies.size() / 2];
+        r.p99_ns = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+        printf("%-18s %-24s %12.0f ops/s %10.1f MB/s  p50 %9.0f ns  p99 %9.0f ns\n", name.c_str(), op, r.ops_per_sec,
+               r.bytes_per_sec / 1e6, r.p50_ns, r.p99_ns);
+        results.push_back(std::move(r));
+    }
+};
+
+std::string read_file(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+        throw std::runtime_error("can not open " + path);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+void write_json(FILE* f, const std::vector<result>& results) {
+    fprintf(f, "[\n");
+    for (auto& r : results)
+        fprintf(f,
+                "  {\"name\":\"%s\",\"op\":\"%s\",\"ops\":%zu,\"ops_per_sec\":%.1f,\"bytes_per_sec\":%.1f,\"p50_ns\":%.0f,"
+                "\"p99_ns\":%.0f}%s\n",
+                r.name.c_str(), r.op.c_str(), r.ops, r.ops_per_sec, r.bytes_per_sec, r.p50_ns, r.p99_ns,
+                &r == &results.back() ? "" : ",");
+    fprintf(f, "]\n");
+}
+
+void check(abieos_context* context, bool ok, const std::string& what) {
+    if (!ok)
+        throw std::runtime_error(what + ": " + abieos_get_error(context));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string abi_dir = "Sources/EosioSwiftAbieosSerializationProvider";
+    const char* json_path = nullptr;
+    uint64_t seed = 1;
+    benchmark bench;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--abi-dir" && i + 1 < argc) {
+            abi_dir = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            bench.min_time = atof(argv[++i]);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            bench.filter = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            fprintf(stderr,
+                    "usage: %s [--abi-dir <dir>] [--min-time <seconds>] [--filter <substring>] [--seed <n>] "
+                    "[--json <file>|-]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    abieos_context* context = abieos_create();
+    try {
+        for (auto& abi : abis) {
+            std::string json = abi.file ? read_file(abi_dir + "/" + abi.file) : abi.json;
+            uint64_t contract = abieos_string_to_name(context, abi.contract);
+            check(context, abieos_abi_json_to_bin(context, json.c_str()), abi.contract);
+            std::vector<char> bin(abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context));
+            bench.run(abi.contract, "set_abi", json.size(),
+                      [&] { return abieos_set_abi(context, contract, json.c_str()); });
+            bench.run(abi.contract, "set_abi_bin", bin.size(),
+                      [&] { return abieos_set_abi_bin(context, contract, bin.data(), bin.size()); });
+            check(context, abieos_set_abi(context, contract, json.c_str()), abi.contract);
+        }
+
+        auto payloads = make_payloads();
+        abieos_random_options options{16, 64, 4};
+        for (auto p : random_payloads) {
+            uint64_t contract = abieos_string_to_name(context, p.contract);
+            check(context, abieos_random_bin(context, contract, p.type, seed, &options), p.name);
+            const char* json = abieos_bin_to_json(context, contract, p.type, abieos_get_bin_data(context),
+                                                  abieos_get_bin_size(context));
+            check(context, json, p.name);
+            p.json = json;
+            payloads.push_back(std::move(p));
+        }
+
+        for (auto& p : payloads) {
+            uint64_t contract = abieos_string_to_name(context, p.contract);
+            check(context, abieos_json_to_bin(context, contract, p.type, p.json.c_str()), p.name);
+            std::vector<char> bin(abieos_get_bin_data(context), abieos_get_bin_data(context) + abieos_get_bin_size(context));
+            std::string hex = abieos_get_bin_hex(context);
+            bench.run(p.name, "json_to_bin", p.json.size(),
+                      [&] { return abieos_json_to_bin(context, contract, p.type, p.json.c_str()); });
+            bench.run(p.name, "json_to_bin_reorderable", p.json.size(),
+                      [&] { return abieos_json_to_bin_reorderable(context, contract, p.type, p.json.c_str()); });
+            bench.run(p.name, "bin_to_json", bin.size(),
+                      [&] { return abieos_bin_to_json(context, contract, p.type, bin.data(), bin.size()) != nullptr; });
+            bench.run(p.name, "hex_to_json", hex.size(),
+                      [&] { return abieos_hex_to_json(context, contract, p.type, hex.c_str()) != nullptr; });
+        }
+
+        size_t name_bytes = 0;
+        std::vector<uint64_t> values;
+        for (auto* n : names) {
+            name_bytes += strlen(n);
+            values.push_back(abieos_string_to_name(context, n));
+        }
+        bench.run("names", "string_to_name", name_bytes, [&] {
+            uint64_t sum = 0;
+            for (auto* n : names)
+                sum += abieos_string_to_name(context, n);
+            return sum != 0;
+        });
+        bench.run("names", "name_to_string", name_bytes, [&] {
+            bool ok = true;
+            for (auto v : values)
+                ok &= abieos_name_to_string(context, v) != nullptr;
+            return ok;
+        });
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        abieos_destroy(context);
+        return 1;
+    }
+    abieos_destroy(context);
+
+    if (json_path) {
+        FILE* f = strcmp(json_path, "-") ? fopen(json_path, "w") : stdout;
+        if (!f) {
+            fprintf(stderr, "error: can not open %s\n", json_path);
+            return 1;
+        }
+        write_json(f, bench.results);
+        if (f != stdout)
+            fclose(f);
+    }
+}
@@ -0,0 +1,224 @@
+// Replays a recorded state-history session and compares the zero-copy views in
+// eosio/ship_reader.hpp against a full decode into the ship_protocol.hpp types. The filter run
+// keeps only eosio.token actions and rows.
+//
+// Build:
+//    c++ -std=gnu++17 -O3 -I Sources/Abieos Benchmarks/ship_reader_benchmark.cpp -o ship_reader_benchmark
+//
+// Usage:
+//    ship_reader_benchmark <capture> [iterations]
+//    ship_reader_benchmark --generate <capture> [blocks] [seed]
+//
+// A capture is a sequence of get_blocks_result messages, each preceded by its size as a little-endian
+// uint32 (see blocks_result_reader). --generate writes a synthetic capture so that runs are
+// reproducible without access to a node.
+
+#include <eosio/ship_reader.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+
+using namespace eosio::ship_protocol;
+
+namespace {
+
+std::vector<char> read_file(const char* path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+        throw std::runtime_error(std::string("can not open ") + path);
+    return std::vector<char>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+void write_message(std::vector<char>& capture, const std::vector<char>& message) {
+    uint32_t size = message.size();
+    capture.insert(capture.end(), (const char*)&size, (const char*)&size + sizeof(size));
+    capture.insert(capture.end(), message.begin(), message.end());
+}
+
+std::vector<char> generate(uint32_t num_blocks, uint32_t seed) {
+    std::mt19937_64 rng(seed);
+    auto rand_name = [&] { return eosio::name{ rng() & ~uint64_t(0xf) }; };
+    std::vector<char> data(64);
+    std::vector<char> capture;
+    for (uint32_t block_num = 1; block_num <= num_blocks; ++block_num) {
+        signed_block_v0 block;
+        block.producer = rand_name();
+        std::vector<transaction_trace> traces;
+        std::vector<table_delta> deltas;
+        table_delta_v0 rows_delta{ "contract_row" };
+        std::vector<std::vector<char>> row_storage; // moving a vector keeps its buffer
+
+        for (uint32_t i = rng() % 32; i > 0; --i) {
+            transaction_trace_v0 trace;
+            trace.cpu_usage_us = rng() % 1000;
+            for (uint32_t j = 1 + rng() % 4; j > 0; --j) {
+                action_trace_v1 at;
+                at.receipt.emplace(action_receipt_v0{ rand_name() });
+                at.receiver = rand_name();
+                at.act.account = j % 2 ? eosio::name{ "eosio.token" } : at.receiver;
+                at.act.name = rand_name();
+                at.act.authorization.push_back({ rand_name(), eosio::name{ "active" } });
+                at.act.data = { data.data(), rng() % data.size() };
+                at.console = std::string(rng() % 16, 'x');
+                trace.action_traces.push_back(std::move(at));
+
+                row_storage.push_back(eosio::convert_to_bin(contract_row{ contract_row_v0{
+                    trace.action_traces.size() % 2 ? eosio::name{ "eosio.token" } : rand_name(), rand_name(),
+                    eosio::name{ "accounts" }, rng(), rand_name(), { data.data(), 16 } } }));
+                rows_delta.rows.push_back({ true, row_storage.back() });
+            }
+            block.transactions.push_back({ { transaction_status::executed, trace.cpu_usage_us, 1 }, trace.id });
+            traces.push_back(std::move(trace));
+        }
+        deltas.push_back(std::move(rows_delta));
+
+        auto block_bin  = eosio::convert_to_bin(block);
+        auto traces_bin = eosio::convert_to_bin(traces);
+        auto deltas_bin = eosio::convert_to_bin(deltas);
+        get_blocks_result_v0 r;
+        r.head = r.last_irreversible = { num_blocks };
+        r.this_block.emplace(block_position{ block_num });
+        r.block.emplace(block_bin);
+        r.traces.emplace(traces_bin);
+        r.deltas.emplace(deltas_bin);
+        std::vector<char> message;
+        eosio::push_varuint32(message, 1); // result: get_blocks_result_v0
+        eosio::convert_to_bin(r, message);
+        write_message(capture, message);
+    }
+    return capture;
+}
+
+struct counts {
+    uint64_t blocks  = 0;
+    uint64_t actions = 0;
+    uint64_t rows    = 0;
+    uint64_t token   = 0; // rows owned by eosio.token; keeps the work observable
+};
+
+counts run_views(const std::vector<char>& capture) {
+    counts c;
+    blocks_result_reader reader{ capture };
+    blocks_result_view r;
+    while (reader.next(r)) {
+        ++c.blocks;
+        for_each_transaction_trace(r.traces, [&](const transaction_trace_v0_view& trace) {
+            for_each_action_trace(trace, [&](const action_trace_view&) { ++c.actions; });
+        });
+        for_each_table_delta(r.deltas, [&](const table_delta_v0_view& delta) {
+            if (delta.name != "contract_row")
+                return;
+            delta.rows.for_each([&](const row& row) {
+                ++c.rows;
+                auto data = row.data;
+                contract_row cr;
+                from_bin(cr, data);
+                c.token += std::get<0>(cr).code == eosio::name{ "eosio.token" };
+            });
+        });
+    }
+    return c;
+}
+
+// Only eosio.token actions and rows, selected with a ship_filter.
+counts run_filtered(const std::vector<char>& capture) {
+    counts      c;
+    ship_filter filter;
+    filter.code.insert(eosio::name{ "eosio.token" });
+    blocks_result_reader reader{ capture };
+    blocks_result_view   r;
+    while (reader.next(r)) {
+        ++c.blocks;
+        for_each_action_trace(r.traces, filter, [&](const action_trace_view&) { ++c.actions; });
+        for_each_table_delta(r.deltas, [&](const table_delta_v0_view& delta) {
+            for_each_contract_row(delta, filter, [&](const row&) {
+                ++c.rows;
+                ++c.token;
+            });
+        });
+    }
+    return c;
+}
+
+counts run_full(const std::vector<char>& capture) {
+    counts c;
+    eosio::input_stream messages{ capture };
+    while (messages.remaining()) {
+        uint32_t size;
+        messages.read_raw(size);
+        eosio::input_stream message{ messages.pos, size };
+        messages.skip(size);
+        result r;
+        from_bin(r, message);
+        auto* v0 = std::get_if<get_blocks_result_v0>(&r);
+        if (!v0)
+            continue;
+        ++c.blocks;
+        signed_block_v0                block;
+        std::vector<transaction_trace> traces;
+        std::vector<table_delta>       deltas;
+        if (v0->block)
+            from_bin(block, *v0->block);
+        if (v0->traces)
+            from_bin(traces, *v0->traces);
+        if (v0->deltas)
+            from_bin(deltas, *v0->deltas);
+        for (auto& trace : traces)
+            c.actions += std::get<0>(trace).action_traces.size();
+        for (auto& delta : deltas) {
+            auto& d = std::get<0>(delta);
+            if (d.name != "contract_row")
+                continue;
+            for (auto& row : d.rows) {
+                ++c.rows;
+                contract_row cr;
+                from_bin(cr, row.data);
+                c.token += std::get<0>(cr).code == eosio::name{ "eosio.token" };
+            }
+        }
+    }
+    return c;
+}
+
+template <typename F>
+void bench(const char* label, const std::vector<char>& capture, int iterations, F f) {
+    counts c;
+    auto   start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        c = f(capture);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double                        bytes   = double(capture.size()) * iterations;
+    printf("%-6s blocks=%llu actions=%llu rows=%llu token_rows=%llu  %.3f s  %.1f MB/s  %.0f blocks/s\n", label,
+           (unsigned long long)c.blocks, (unsigned long long)c.actions, (unsigned long long)c.rows,
+           (unsigned long long)c.token, elapsed.count(), bytes / elapsed.count() / 1e6,
+           c.blocks * iterations / elapsed.count());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        if (argc >= 3 && std::string(argv[1]) == "--generate") {
+            auto capture = generate(argc >= 4 ? atoi(argv[3]) : 10000, argc >= 5 ? atoi(argv[4]) : 1);
+            std::ofstream(argv[2], std::ios::binary).write(capture.data(), capture.size());
+            return 0;
+        }
+        if (argc < 2) {
+            fprintf(stderr, "usage: %s <capture> [iterations]\n       %s --generate <capture> [blocks] [seed]\n",
+                    argv[0], argv[0]);
+            return 1;
+        }
+        auto capture    = read_file(argv[1]);
+        int  iterations = argc >= 3 ? atoi(argv[2]) : 5;
+        bench("views", capture, iterations, run_views);
+        bench("filter", capture, iterations, run_filtered);
+        bench("full", capture, iterations, run_full);
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}
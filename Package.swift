@@ -57,9 +57,11 @@ let package = Package(
             */
             exclude: [
                 "abieos.hpp",
+                "abieos_columns.hpp",
                 "abieos_exception.hpp",
                 "abieos_numeric.hpp",
                 "abieos_ripemd160.hpp",
+                "abieos_sha256.hpp",
                 "eosio/abi.hpp",
                 "eosio/asset.hpp",
                 "eosio/bytes.hpp",
@@ -80,6 +82,7 @@ let package = Package(
                 "eosio/operators.hpp",
                 "eosio/reflection.hpp",
                 "eosio/ship_protocol.hpp",
+                "eosio/ship_reader.hpp",
                 "eosio/stream.hpp",
                 "eosio/symbol.hpp",
                 "eosio/time.hpp",
@@ -135,7 +138,7 @@ let package = Package(
         ),
         .testTarget(
             name: "EosioSwiftAbieosSerializationProviderTests",
-            dependencies: ["EosioSwiftAbieosSerializationProvider"],
+            dependencies: ["Abieos", "EosioSwiftAbieosSerializationProvider"],
             path: "Tests/EosioSwiftAbieosSerializationProviderTests"
         ),
         .testTarget(
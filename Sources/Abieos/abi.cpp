@@ -1,13 +1,18 @@
 #include "eosio/abi.hpp"
 #include "abieos.hpp"
 
+#include <algorithm>
+#include <unordered_map>
+
 using namespace eosio;
 
 namespace {
 
+using abi_type_map = std::map<std::string, abi_type, std::less<>>;
+
 template <int i>
-bool ends_with(const std::string& s, const char (&suffix)[i]) {
-    return s.size() >= i - 1 && !strcmp(s.c_str() + s.size() - (i - 1), suffix);
+bool ends_with(std::string_view s, const char (&suffix)[i]) {
+    return s.size() >= i - 1 && s.substr(s.size() - (i - 1)) == std::string_view{suffix, i - 1};
 }
 
 template <typename T>
@@ -24,12 +29,36 @@ struct abi_serializer_impl : abi_serializer {
                              bool start) const override {
         return ::abieos::bin_to_json((T*)nullptr, state, allow_extensions, type, start);
     }
+    void skip_bin(::abieos::skip_bin_state& state, bool allow_extensions, const abi_type* type,
+                             bool start) const override {
+        return ::abieos::skip_bin((T*)nullptr, state, allow_extensions, type, start);
+    }
+    void bin_to_key(::abieos::bin_to_key_state& state, bool allow_extensions, const abi_type* type,
+                             bool start) const override {
+        return ::abieos::bin_to_key((T*)nullptr, state, allow_extensions, type, start);
+    }
+    void random_bin(::abieos::random_bin_state& state, bool allow_extensions, const abi_type* type,
+                             bool start) const override {
+        return ::abieos::random_bin((T*)nullptr, state, allow_extensions, type, start);
+    }
+    bool check_bin(::abieos::check_bin_state& state, bool allow_extensions, const abi_type* type,
+                             bool start) const noexcept override {
+        return ::abieos::check_bin((T*)nullptr, state, allow_extensions, type, start);
+    }
+    void bin_to_document(::abieos::bin_to_document_state& state, bool allow_extensions, const abi_type* type,
+                             bool start) const override {
+        return ::abieos::bin_to_document((T*)nullptr, state, allow_extensions, type, start);
+    }
+    size_t fixed_bin_size() const override {
+        return ::abieos::fixed_bin_size((T*)nullptr);
+    }
 };
 
 template <typename T>
 constexpr auto abi_serializer_for = abi_serializer_impl<T>{};
 
-abi_type::alias resolve(std::map<std::string, abi_type>& abi_types, const abi_type::alias_def* type, int depth);
+template <typename Name>
+abi_type::alias resolve_alias(abi_type_map& abi_types, const Name* type, int depth);
 
 template<typename... T, typename... A>
 bool holds_any_alternative(const std::variant<A...>& v) {
@@ -75,29 +104,74 @@ constexpr void for_each_abi_type(F f) {
     f((asset*)nullptr);
 }
 
-abi_type* get_type(std::map<std::string, abi_type>& abi_types,
-                           const std::string& name, int depth) {
+abi_type_map make_builtin_types() {
+    abi_type_map types;
+    for_each_abi_type([&](auto* p) {
+        const char* name = get_type_name(p);
+        types.try_emplace(name, name, abi_type::builtin{}, &abi_serializer_for<std::decay_t<decltype(*p)>>);
+    });
+    types.try_emplace("extended_asset", "extended_asset",
+                      abi_type::struct_{nullptr, {{"quantity", &types.find("asset")->second},
+                                                  {"contract", &types.find("name")->second}}},
+                      &abi_serializer_for<::abieos::pseudo_object>);
+
+    std::vector<abi_type*> bases;
+    for (auto& [_, t] : types)
+        bases.push_back(&t);
+    for (auto* base : bases) {
+        auto& array = types.try_emplace(base->name + "[]", base->name + "[]", abi_type::array{base},
+                                        &abi_serializer_for<::abieos::pseudo_array>).first->second;
+        auto& optional = types.try_emplace(base->name + "?", base->name + "?", abi_type::optional{base},
+                                           &abi_serializer_for<::abieos::pseudo_optional>).first->second;
+        for (auto* t : {base, &array, &optional})
+            types.try_emplace(t->name + "$", t->name + "$", abi_type::extension{t},
+                              &abi_serializer_for<::abieos::pseudo_extension>);
+    }
+    return types;
+}
+
+// Heap bytes held by s; 0 if s is short enough to be stored inline
+size_t heap_size(const std::string& s) {
+    auto inline_begin = (const char*)&s;
+    if (s.data() >= inline_begin && s.data() < inline_begin + sizeof(s))
+        return 0;
+    return s.capacity() + 1;
+}
+
+// Approximate size of a std::map or std::set node holding a T
+template <typename T>
+constexpr size_t node_size = 4 * sizeof(void*) + sizeof(T);
+
+// An abi's own types shadow the shared ones, except that it may not redefine a builtin type or extended_asset
+bool is_builtin_base(std::string_view name) {
+    auto* t = find_builtin_type(name);
+    return t && !holds_any_alternative<abi_type::optional, abi_type::array, abi_type::extension>(t->_data);
+}
+
+abi_type* get_type(abi_type_map& abi_types, std::string_view name, int depth) {
    eosio::check(depth < 32,
         eosio::convert_abi_error(abi_error::recursion_limit_reached));
     auto it = abi_types.find(name);
     if (it == abi_types.end()) {
+        if (auto* builtin = find_builtin_type(name))
+            return builtin;
         if (ends_with(name, "?")) {
             auto base = get_type(abi_types, name.substr(0, name.size() - 1), depth + 1);
             eosio::check(!holds_any_alternative<abi_type::optional, abi_type::array, abi_type::extension>(base->_data),
                   eosio::convert_abi_error(abi_error::invalid_nesting));
-            auto [iter, success] = abi_types.try_emplace(name, name, abi_type::optional{base}, &abi_serializer_for< ::abieos::pseudo_optional>);
+            auto [iter, success] = abi_types.try_emplace(std::string{name}, std::string{name}, abi_type::optional{base}, &abi_serializer_for< ::abieos::pseudo_optional>);
             return &iter->second;
         } else if (ends_with(name, "[]")) {
             auto element = get_type(abi_types, name.substr(0, name.size() - 2), depth + 1);
             eosio::check(!holds_any_alternative<abi_type::optional, abi_type::array, abi_type::extension>(element->_data),
                   eosio::convert_abi_error(abi_error::invalid_nesting));
-            auto [iter, success] = abi_types.try_emplace(name, name, abi_type::array{element}, &abi_serializer_for< ::abieos::pseudo_array>);
+            auto [iter, success] = abi_types.try_emplace(std::string{name}, std::string{name}, abi_type::array{element}, &abi_serializer_for< ::abieos::pseudo_array>);
             return &iter->second;
         } else if (ends_with(name, "$")) {
             auto base = get_type(abi_types, name.substr(0, name.size() - 1), depth + 1);
             eosio::check(!std::holds_alternative<abi_type::extension>(base->_data),
                   eosio::convert_abi_error(abi_error::invalid_nesting));
-            auto [iter, success] = abi_types.try_emplace(name, name, abi_type::extension{base}, &abi_serializer_for< ::abieos::pseudo_extension>);
+            auto [iter, success] = abi_types.try_emplace(std::string{name}, std::string{name}, abi_type::extension{base}, &abi_serializer_for< ::abieos::pseudo_extension>);
             return &iter->second;
         } else
            eosio::check(false, eosio::convert_abi_error(abi_error::unknown_type));
@@ -107,7 +181,11 @@ abi_type* get_type(std::map<std::string, abi_type>& abi_types,
     if (auto* alias = std::get_if<abi_type::alias>(&it->second._data)) {
         return alias->type;
     } else if(auto* alias = std::get_if<const abi_type::alias_def*>(&it->second._data)) {
-        auto base = resolve(abi_types, *alias, depth);
+        auto base = resolve_alias(abi_types, *alias, depth);
+        it->second._data = base;
+        return base.type;
+    } else if(auto* alias = std::get_if<const abi_type::alias_def_view*>(&it->second._data)) {
+        auto base = resolve_alias(abi_types, *alias, depth);
         it->second._data = base;
         return base.type;
     }
@@ -115,7 +193,9 @@ abi_type* get_type(std::map<std::string, abi_type>& abi_types,
     return &it->second;
 }
 
-abi_type::struct_ resolve(std::map<std::string, abi_type>& abi_types, const struct_def* type, int depth) {
+// Def is struct_def or struct_def_view
+template <typename Def>
+abi_type::struct_ resolve_struct(abi_type_map& abi_types, const Def* type, int depth) {
    eosio::check(depth < 32,
         eosio::convert_abi_error(abi_error::recursion_limit_reached));
     abi_type::struct_ result;
@@ -123,7 +203,10 @@ abi_type::struct_ resolve(std::map<std::string, abi_type>& abi_types, const stru
         auto base = get_type(abi_types, type->base, depth + 1);
 
         if(auto* base_def = std::get_if<const struct_def*>(&base->_data)) {
-            auto b = resolve(abi_types, *base_def, depth + 1);
+            auto b = resolve_struct(abi_types, *base_def, depth + 1);
+            base->_data = std::move(b);
+        } else if(auto* base_def = std::get_if<const struct_def_view*>(&base->_data)) {
+            auto b = resolve_struct(abi_types, *base_def, depth + 1);
             base->_data = std::move(b);
         }
         if(auto* b = std::get_if<abi_type::struct_>(&base->_data)) {
@@ -132,6 +215,7 @@ abi_type::struct_ resolve(std::map<std::string, abi_type>& abi_types, const stru
            eosio::check(false, eosio::convert_abi_error(abi_error::base_not_a_struct));
         }
     }
+    result.fields.reserve(result.fields.size() + type->fields.size());
     for (auto& field : type->fields) {
         auto t = get_type(abi_types, field.type, depth + 1);
         result.fields.push_back(abi_field{field.name, t});
@@ -140,26 +224,55 @@ abi_type::struct_ resolve(std::map<std::string, abi_type>& abi_types, const stru
 }
 
 
-abi_type::variant resolve(std::map<std::string, abi_type>& abi_types, const variant_def* type, int depth) {
+// Def is variant_def or variant_def_view
+template <typename Def>
+abi_type::variant resolve_variant(abi_type_map& abi_types, const Def* type, int depth) {
    eosio::check(depth < 32,
         eosio::convert_abi_error(abi_error::recursion_limit_reached));
     abi_type::variant result;
-    for (const std::string& field : type->types) {
+    result.reserve(type->types.size());
+    for (std::string_view field : type->types) {
         auto t = get_type(abi_types, field, depth + 1);
         result.push_back({field, t});
     }
     return result;
 }
 
-abi_type::alias resolve(std::map<std::string, abi_type>& abi_types, const abi_type::alias_def* type, int depth) {
+// Name is alias_def or alias_def_view
+template <typename Name>
+abi_type::alias resolve_alias(abi_type_map& abi_types, const Name* type, int depth) {
     auto t = get_type(abi_types, *type, depth + 1);
     eosio::check(!std::holds_alternative<abi_type::extension>(t->_data),
         eosio::convert_abi_error(abi_error::extension_typedef));
     return abi_type::alias{t};
 }
 
+abi_type::struct_ resolve(abi_type_map& abi_types, const struct_def* type, int depth) {
+    return resolve_struct(abi_types, type, depth);
+}
+
+abi_type::struct_ resolve(abi_type_map& abi_types, const struct_def_view* type, int depth) {
+    return resolve_struct(abi_types, type, depth);
+}
+
+abi_type::variant resolve(abi_type_map& abi_types, const variant_def* type, int depth) {
+    return resolve_variant(abi_types, type, depth);
+}
+
+abi_type::variant resolve(abi_type_map& abi_types, const variant_def_view* type, int depth) {
+    return resolve_variant(abi_types, type, depth);
+}
+
+abi_type::alias resolve(abi_type_map& abi_types, const abi_type::alias_def* type, int depth) {
+    return resolve_alias(abi_types, type, depth);
+}
+
+abi_type::alias resolve(abi_type_map& abi_types, const abi_type::alias_def_view* type, int depth) {
+    return resolve_alias(abi_types, type, depth);
+}
+
 struct fill_t {
-   std::map<std::string, abi_type>& abi_types;
+   abi_type_map& abi_types;
    abi_type& type;
    int depth;
    template<typename T>
@@ -172,59 +285,124 @@ struct fill_t {
    }
 };
 
-void fill(std::map<std::string, abi_type>& abi_types, abi_type& type, int depth) {
+void fill(abi_type_map& abi_types, abi_type& type, int depth) {
    return std::visit(fill_t{abi_types, type, depth}, type._data);
 }
 
 }
 
+abi_type* eosio::find_builtin_type(std::string_view name) {
+    static abi_type_map types = make_builtin_types();
+    // Every type name in an abi is looked up here, so the lookup hashes instead of walking the map
+    static std::unordered_map<std::string_view, abi_type*> index = [] {
+        std::unordered_map<std::string_view, abi_type*> result;
+        for (auto& [name, type] : types)
+            result.emplace(name, &type);
+        return result;
+    }();
+    auto it = index.find(name);
+    return it == index.end() ? nullptr : it->second;
+}
 
 const abi_type* eosio::abi::get_type(const std::string& name) {
    return ::get_type(abi_types, name, 0);
 }
 
-void eosio::convert(const abi_def& abi, eosio::abi& c) {
-    for (auto& a : abi.actions)
-        c.action_types[a.name] = a.type;
-    for (auto& t : abi.tables)
-        c.table_types[t.name] = t.type;
-    for (auto& r : abi.action_results.value)
-        c.action_result_types[r.name] = r.result_type;
-    for_each_abi_type([&](auto* p) {
-        const char* name = get_type_name(p);
-        c.abi_types.try_emplace(name, name, abi_type::builtin{}, &abi_serializer_for<std::decay_t<decltype(*p)>>);
-    });
-    {
-        c.abi_types.try_emplace("extended_asset", "extended_asset",
-                                abi_type::struct_{nullptr, {{"quantity", &c.abi_types.find("asset")->second},
-                                                            {"contract", &c.abi_types.find("name")->second}}},
-                                &abi_serializer_for<::abieos::pseudo_object>);
+void eosio::abi::intern_names() {
+    std::vector<abi_field*> fields;
+    for (auto& [_, t] : abi_types) {
+        if (auto* s = std::get_if<abi_type::struct_>(&t._data)) {
+            for (auto& field : s->fields)
+                fields.push_back(&field);
+        } else if (auto* v = std::get_if<abi_type::variant>(&t._data)) {
+            for (auto& field : *v)
+                fields.push_back(&field);
+        }
+    }
+    // Sorting brings equal names together without allocating a node for each name
+    std::sort(fields.begin(), fields.end(), [](auto* a, auto* b) { return a->name < b->name; });
+    size_t size = 0;
+    for (size_t i = 0; i < fields.size(); ++i)
+        if (!i || fields[i]->name != fields[i - 1]->name)
+            size += fields[i]->name.size();
+    std::vector<char> new_names(size);
+    size_t offset = 0;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        auto name = fields[i]->name;
+        if (i && name == fields[i - 1]->name) {
+            fields[i]->name = fields[i - 1]->name;
+            continue;
+        }
+        memcpy(new_names.data() + offset, name.data(), name.size());
+        fields[i]->name = {new_names.data() + offset, name.size()};
+        offset += name.size();
     }
+    names = std::move(new_names);
+}
+
+abi_memory_usage eosio::abi::memory_usage() const {
+    abi_memory_usage result;
+    for (auto* m : {&action_types, &table_types, &kv_tables, &action_result_types})
+        for (auto& [_, type] : *m)
+            result.bytes += node_size<std::pair<const eosio::name, std::string>> + heap_size(type);
+    result.names = names.size();
+    result.bytes += names.capacity();
+    for (auto& [name, type] : abi_types) {
+        ++result.types;
+        result.bytes += node_size<std::pair<const std::string, abi_type>> + heap_size(name) + heap_size(type.name);
+        auto* fields = type.as_struct() ? &type.as_struct()->fields : type.as_variant();
+        if (fields) {
+            result.fields += fields->size();
+            result.bytes += fields->capacity() * sizeof(abi_field);
+        }
+    }
+    return result;
+}
+
+namespace {
+
+// The parts of a binary abi which convert(input_stream, abi&) keeps after reading it
+struct type_def_view {
+    std::string_view new_type_name;
+    std::string_view type;
+};
 
+struct abi_def_view {
+    std::vector<type_def_view>                                 types;
+    std::vector<struct_def_view>                               structs;
+    might_not_exist<std::vector<variant_def_view>>             variants;
+    might_not_exist<std::map<eosio::name, kv_table_entry_def>> kv_tables;
+};
+
+// Def is abi_def or abi_def_view. abi_types refers to def's names until intern_names copies the field names.
+template <typename Def>
+void convert_types(const Def& abi, eosio::abi& c) {
     for (auto& t : abi.types) {
        eosio::check(!t.new_type_name.empty(),
             eosio::convert_abi_error(abi_error::missing_name));
-        auto [_, inserted] = c.abi_types.try_emplace(t.new_type_name, t.new_type_name, &t.type, nullptr);
-        eosio::check(inserted,
+        auto [_, inserted] = c.abi_types.try_emplace(std::string{t.new_type_name}, std::string{t.new_type_name}, &t.type, nullptr);
+        eosio::check(inserted && !is_builtin_base(t.new_type_name),
             eosio::convert_abi_error(abi_error::redefined_type));
     }
     for (auto& s : abi.structs) {
        eosio::check(!s.name.empty(),
             eosio::convert_abi_error(abi_error::missing_name));
-        auto [it, inserted] = c.abi_types.try_emplace(s.name, s.name, &s, &abi_serializer_for<::abieos::pseudo_object>);
-        eosio::check(inserted,
+        auto [it, inserted] = c.abi_types.try_emplace(std::string{s.name}, std::string{s.name}, &s, &abi_serializer_for<::abieos::pseudo_object>);
+        eosio::check(inserted && !is_builtin_base(s.name),
             eosio::convert_abi_error(abi_error::redefined_type));
     }
     for (auto& v : abi.variants.value) {
        eosio::check(!v.name.empty(),
             eosio::convert_abi_error(abi_error::missing_name));
-        auto [it, inserted] = c.abi_types.try_emplace(v.name, v.name, &v, &abi_serializer_for<::abieos::pseudo_variant>);
-        eosio::check(inserted,
+        auto [it, inserted] = c.abi_types.try_emplace(std::string{v.name}, std::string{v.name}, &v, &abi_serializer_for<::abieos::pseudo_variant>);
+        eosio::check(inserted && !is_builtin_base(v.name),
             eosio::convert_abi_error(abi_error::redefined_type));
     }
     for (auto& [_, t] : c.abi_types) {
         fill(c.abi_types, t, 0);
     }
+    // Until now, field names point into abi
+    c.intern_names();
 
     for (const auto& [key, val] : abi.kv_tables.value) {
         std::vector<char> bytes;
@@ -234,6 +412,107 @@ void eosio::convert(const abi_def& abi, eosio::abi& c) {
     }
 }
 
+// Reads a sequence's size, then calls f for each element
+template <typename F>
+void for_each_element(input_stream& bin, F f) {
+    uint32_t size;
+    varuint32_from_bin(size, bin);
+    for (uint32_t i = 0; i < size; ++i)
+        f();
+}
+
+// Reads a sequence into v. An element takes at least a byte, so a size which is larger than the rest of the abi
+// isn't reserved.
+template <typename T, typename F>
+void read_elements(std::vector<T>& v, input_stream& bin, F f) {
+    uint32_t size;
+    varuint32_from_bin(size, bin);
+    v.reserve(std::min<size_t>(size, bin.remaining()));
+    for (uint32_t i = 0; i < size; ++i)
+        f(v.emplace_back());
+}
+
+std::string_view read_string(input_stream& bin) {
+    std::string_view result;
+    from_bin(result, bin);
+    return result;
+}
+
+} // namespace
+
+void eosio::convert(const abi_def& abi, eosio::abi& c) {
+    for (auto& a : abi.actions)
+        c.action_types[a.name] = a.type;
+    for (auto& t : abi.tables)
+        c.table_types[t.name] = t.type;
+    for (auto& r : abi.action_results.value)
+        c.action_result_types[r.name] = r.result_type;
+    convert_types(abi, c);
+}
+
+// Reads the fields of abi_def in order. The action, table and action result types go straight into c, and the
+// type definitions into views of bin; the rest is skipped.
+void eosio::convert(input_stream bin, eosio::abi& c) {
+    abi_def_view abi;
+    read_string(bin); // version
+    read_elements(abi.types, bin, [&](type_def_view& t) {
+        t.new_type_name = read_string(bin);
+        t.type          = read_string(bin);
+    });
+    read_elements(abi.structs, bin, [&](struct_def_view& s) {
+        s.name = read_string(bin);
+        s.base = read_string(bin);
+        read_elements(s.fields, bin, [&](field_def_view& f) {
+            f.name = read_string(bin);
+            f.type = read_string(bin);
+        });
+    });
+    for_each_element(bin, [&] { // actions
+        eosio::name name;
+        from_bin(name, bin);
+        c.action_types[name] = read_string(bin);
+        read_string(bin); // ricardian_contract
+    });
+    for_each_element(bin, [&] { // tables
+        eosio::name name;
+        from_bin(name, bin);
+        read_string(bin); // index_type
+        for_each_element(bin, [&] { read_string(bin); }); // key_names
+        for_each_element(bin, [&] { read_string(bin); }); // key_types
+        c.table_types[name] = read_string(bin);
+    });
+    for_each_element(bin, [&] { // ricardian_clauses
+        read_string(bin);
+        read_string(bin);
+    });
+    for_each_element(bin, [&] { // error_messages
+        uint64_t error_code;
+        from_bin(error_code, bin);
+        read_string(bin);
+    });
+    for_each_element(bin, [&] { // abi_extensions
+        uint16_t id;
+        input_stream data;
+        from_bin(id, bin);
+        from_bin(data, bin);
+    });
+    if (bin.remaining()) {
+        read_elements(abi.variants.value, bin, [&](variant_def_view& v) {
+            v.name = read_string(bin);
+            read_elements(v.types, bin, [&](std::string_view& type) { type = read_string(bin); });
+        });
+    }
+    if (bin.remaining()) {
+        for_each_element(bin, [&] { // action_results
+            eosio::name name;
+            from_bin(name, bin);
+            c.action_result_types[name] = read_string(bin);
+        });
+    }
+    from_bin(abi.kv_tables, bin);
+    convert_types(abi, c);
+}
+
 void to_abi_def(abi_def& def, const std::string& name, const abi_type::builtin&) {}
 void to_abi_def(abi_def& def, const std::string& name, const abi_type::optional&) {}
 void to_abi_def(abi_def& def, const std::string& name, const abi_type::array&) {}
@@ -259,7 +538,7 @@ void to_abi_def(abi_def& def, const std::string& name, const abi_type::struct_&
    }
    for(std::size_t i = field_offset; i < struct_.fields.size(); ++i) {
       const abi_field& field = struct_.fields[i];
-      fields.push_back({field.name, field.type->name});
+      fields.push_back({std::string{field.name}, field.type->name});
    }
    def.structs.push_back({name, std::move(base), std::move(fields)});
 }
@@ -279,28 +558,192 @@ void eosio::convert(const eosio::abi& abi, eosio::abi_def& def) {
    }
 }
 
+template <typename F>
+void to_snapshot(abi_snapshot_type& type, F&& index, const abi_type::builtin&) {
+   type.kind = uint8_t(abi_snapshot_kind::builtin);
+}
+
+template <typename F, typename T>
+void to_snapshot(abi_snapshot_type& type, F&& index, const T*) {
+   eosio::check(false, eosio::convert_abi_error(eosio::abi_error::bad_abi));
+}
+
+template <typename F>
+void to_snapshot(abi_snapshot_type& type, F&& index, const abi_type::alias& alias) {
+   type.kind = uint8_t(abi_snapshot_kind::alias);
+   type.type = index(alias.type);
+}
+
+template <typename F>
+void to_snapshot(abi_snapshot_type& type, F&& index, const abi_type::optional& optional) {
+   type.kind = uint8_t(abi_snapshot_kind::optional);
+   type.type = index(optional.type);
+}
+
+template <typename F>
+void to_snapshot(abi_snapshot_type& type, F&& index, const abi_type::extension& extension) {
+   type.kind = uint8_t(abi_snapshot_kind::extension);
+   type.type = index(extension.type);
+}
+
+template <typename F>
+void to_snapshot(abi_snapshot_type& type, F&& index, const abi_type::array& array) {
+   type.kind = uint8_t(abi_snapshot_kind::array);
+   type.type = index(array.type);
+}
+
+template <typename F>
+void to_snapshot(abi_snapshot_type& type, F&& index, const abi_type::struct_& struct_) {
+   type.kind = uint8_t(abi_snapshot_kind::struct_);
+   if (struct_.base)
+      type.type = index(struct_.base);
+   for (auto& field : struct_.fields)
+      type.fields.push_back({std::string{field.name}, index(field.type)});
+}
+
+template <typename F>
+void to_snapshot(abi_snapshot_type& type, F&& index, const abi_type::variant& variant) {
+   type.kind = uint8_t(abi_snapshot_kind::variant);
+   for (auto& field : variant)
+      type.fields.push_back({std::string{field.name}, index(field.type)});
+}
+
+// Shared types are saved as builtin entries, which refer to them by name
+void eosio::convert(const eosio::abi& abi, eosio::abi_snapshot_contract& snapshot) {
+   snapshot.action_types = abi.action_types;
+   snapshot.table_types = abi.table_types;
+   snapshot.kv_tables = abi.kv_tables;
+   snapshot.action_result_types = abi.action_result_types;
+   std::map<const abi_type*, uint32_t> indexes;
+   for (auto& [_, type] : abi.abi_types)
+      indexes.emplace(&type, indexes.size());
+   std::vector<abi_snapshot_type> shared;
+   auto index = [&](const abi_type* type) {
+      auto [it, inserted] = indexes.try_emplace(type, indexes.size());
+      if (inserted) {
+         eosio::check(find_builtin_type(type->name) == type, eosio::convert_abi_error(eosio::abi_error::bad_abi));
+         shared.push_back({type->name, uint8_t(abi_snapshot_kind::builtin)});
+      }
+      return it->second;
+   };
+   snapshot.types.reserve(abi.abi_types.size());
+   for (auto& [name, type] : abi.abi_types) {
+      auto& t = snapshot.types.emplace_back();
+      t.name = name;
+      std::visit([&](const auto& data) { return to_snapshot(t, index, data); }, type._data);
+   }
+   snapshot.types.insert(snapshot.types.end(), shared.begin(), shared.end());
+}
+
+// Types are created in one pass and linked in a second. The checks keep the invariants which resolving an abi_def
+// establishes, so a damaged snapshot can't produce types which the serializers don't expect.
+void eosio::convert(const eosio::abi_snapshot_contract& snapshot, eosio::abi& c) {
+   using k = abi_snapshot_kind;
+   c.action_types = snapshot.action_types;
+   c.table_types = snapshot.table_types;
+   c.kv_tables = snapshot.kv_tables;
+   c.action_result_types = snapshot.action_result_types;
+
+   std::vector<abi_type*> types;
+   std::vector<k> kinds;
+   types.reserve(snapshot.types.size());
+   kinds.reserve(snapshot.types.size());
+   for (auto& t : snapshot.types) {
+      const abi_serializer* ser = nullptr;
+      switch (k(t.kind)) {
+         case k::builtin: {
+            auto* builtin = find_builtin_type(t.name);
+            eosio::check(builtin, eosio::convert_abi_error(abi_error::unknown_type));
+            types.push_back(builtin);
+            kinds.push_back(builtin->optional_of()    ? k::optional
+                            : builtin->array_of()     ? k::array
+                            : builtin->extension_of() ? k::extension
+                            : builtin->as_struct()    ? k::struct_
+                                                      : k::builtin);
+            continue;
+         }
+         case k::alias: break;
+         case k::optional: ser = optional_abi_serializer; break;
+         case k::extension: ser = extension_abi_serializer; break;
+         case k::array: ser = array_abi_serializer; break;
+         case k::struct_: ser = object_abi_serializer; break;
+         case k::variant: ser = variant_abi_serializer; break;
+         default: eosio::check(false, eosio::convert_abi_error(abi_error::bad_abi));
+      }
+      auto [it, inserted] = c.abi_types.try_emplace(t.name, t.name, abi_type::builtin{}, ser);
+      eosio::check(inserted, eosio::convert_abi_error(abi_error::redefined_type));
+      types.push_back(&it->second);
+      kinds.push_back(k(t.kind));
+   }
+
+   // Returns the type at index, which may not be an alias or any of the kinds in not
+   auto get = [&](uint32_t index, std::initializer_list<k> not_, abi_error error) {
+      eosio::check(index < types.size(), eosio::convert_abi_error(abi_error::bad_abi));
+      eosio::check(kinds[index] != k::alias, eosio::convert_abi_error(abi_error::bad_abi));
+      for (auto kind : not_)
+         eosio::check(kinds[index] != kind, eosio::convert_abi_error(error));
+      return types[index];
+   };
+   for (size_t i = 0; i < types.size(); ++i) {
+      auto& t = snapshot.types[i];
+      auto& data = types[i]->_data;
+      switch (k(t.kind)) {
+         case k::builtin: break;
+         case k::alias: data = abi_type::alias{get(t.type, {k::extension}, abi_error::extension_typedef)}; break;
+         case k::optional:
+            data = abi_type::optional{get(t.type, {k::optional, k::array, k::extension}, abi_error::invalid_nesting)};
+            break;
+         case k::extension: data = abi_type::extension{get(t.type, {k::extension}, abi_error::invalid_nesting)}; break;
+         case k::array:
+            data = abi_type::array{get(t.type, {k::optional, k::array, k::extension}, abi_error::invalid_nesting)};
+            break;
+         case k::struct_: {
+            abi_type::struct_ s;
+            if (t.type != abi_snapshot_no_type) {
+               s.base = get(t.type, {}, abi_error::bad_abi);
+               eosio::check(kinds[t.type] == k::struct_, eosio::convert_abi_error(abi_error::base_not_a_struct));
+            }
+            s.fields.reserve(t.fields.size());
+            for (auto& field : t.fields)
+               s.fields.push_back({field.name, get(field.type, {}, abi_error::bad_abi)});
+            data = std::move(s);
+            break;
+         }
+         case k::variant: {
+            abi_type::variant v;
+            v.reserve(t.fields.size());
+            for (auto& field : t.fields)
+               v.push_back({field.name, get(field.type, {}, abi_error::bad_abi)});
+            data = std::move(v);
+            break;
+         }
+      }
+   }
+   c.intern_names();
+}
+
 const abi_serializer* const eosio::object_abi_serializer = &abi_serializer_for< ::abieos::pseudo_object>;
 const abi_serializer* const eosio::variant_abi_serializer = &abi_serializer_for< ::abieos::pseudo_variant>;
 const abi_serializer* const eosio::array_abi_serializer = &abi_serializer_for< ::abieos::pseudo_array>;
 const abi_serializer* const eosio::extension_abi_serializer = &abi_serializer_for< ::abieos::pseudo_extension>;
 const abi_serializer* const eosio::optional_abi_serializer = &abi_serializer_for< ::abieos::pseudo_optional>;
 
-std::vector<char> eosio::abi_type::json_to_bin_reorderable(std::string_view json, std::function<void()> f) const {
+std::vector<char> eosio::abi_type::json_to_bin_reorderable(std::string_view json) const {
    abieos::jvalue tmp;
-   abieos::json_to_jvalue(tmp, json, f);
+   abieos::json_to_jvalue(tmp, json);
    std::vector<char> result;
-   abieos::json_to_bin(result, this, tmp, f);
+   abieos::json_to_bin(result, this, tmp);
    return result;
 }
 
-std::vector<char> eosio::abi_type::json_to_bin(std::string_view json, std::function<void()> f) const {
+std::vector<char> eosio::abi_type::json_to_bin(std::string_view json) const {
    std::vector<char> result;
-   abieos::json_to_bin(result, this, json, f);
+   abieos::json_to_bin(result, this, json);
    return result;
 }
 
-std::string eosio::abi_type::bin_to_json(input_stream& bin, std::function<void()> f) const {
+std::string eosio::abi_type::bin_to_json(input_stream& bin) const {
    std::string result;
-   abieos::bin_to_json(bin, this, result, f);
+   abieos::bin_to_json(bin, this, result);
    return result;
 }
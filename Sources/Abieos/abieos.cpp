@@ -2,6 +2,8 @@
 
 #include "abieos.h"
 #include "abieos.hpp"
+#include "abieos_columns.hpp"
+#include "abieos_sha256.hpp"
 
 #include <memory>
 
@@ -14,6 +16,18 @@ struct abieos_context_s {
     std::string last_error_buffer{};
     std::string result_str{};
     std::vector<char> result_bin{};
+    std::optional<abieos::column_set> columns{};
+    abieos::scratch_buffers scratch{};
+    size_t scratch_limit = 1024 * 1024;
+    std::unique_ptr<abieos::incremental_json_to_bin> incremental_json_to_bin{};
+    uint64_t incremental_contract = 0;
+    abieos::budget_usage incremental_usage{};
+    abieos::bytes_encoding bytes_encoding = abieos::bytes_encoding::hex;
+    abieos::transcoder transcoder{};
+    abieos::budget budget{};
+
+    bool profiling = false;
+    std::map<std::pair<name, std::string>, type_profile> profile{};
 
     std::map<name, abi> contracts{};
 };
@@ -29,6 +43,54 @@ bool set_error(abieos_context* context, std::string error) noexcept {
     return false;
 }
 
+// Calls f with the hooks for the context's settings. output_size(pos) gives the bytes of output so far, for the budget.
+// Calls which are parts of one conversion share usage.
+template <typename OutputSize, typename F>
+void with_hooks(abieos_context* context, uint64_t contract, budget_usage& usage, OutputSize output_size, F f) {
+    auto limited = [&](auto& hooks) {
+        if (context->budget.unlimited())
+            return f(hooks);
+        budget_hooks<std::decay_t<decltype(hooks)>, OutputSize> budgeted{context->budget, hooks, output_size, usage};
+        f(budgeted);
+    };
+    if (!context->profiling) {
+        no_hooks hooks;
+        return limited(hooks);
+    }
+    profile_hooks hooks;
+    limited(hooks);
+    for (auto& [type, p] : hooks.profile) {
+        auto& total = context->profile[{name{contract}, type->name}];
+        total.count += p.count;
+        total.bytes += p.bytes;
+        total.cycles += p.cycles;
+    }
+}
+
+template <typename OutputSize, typename F>
+void with_hooks(abieos_context* context, uint64_t contract, OutputSize output_size, F f) {
+    budget_usage usage;
+    with_hooks(context, contract, usage, output_size, f);
+}
+
+// output_size for with_hooks when pos counts the bytes written, as in json_to_bin
+size_t pos_is_output_size(size_t pos) { return pos; }
+
+// json_to_bin inserts array sizes after its last step, so the budget checks its final size here
+void check_output_size(abieos_context* context, size_t size) {
+    eosio::check(!context->budget.max_output_size || size <= context->budget.max_output_size,
+                 eosio::convert_abi_error(eosio::abi_error::output_limit_exceeded));
+}
+
+// Trims the context's scratch buffers to its limit on scope exit, whether or not the call succeeded
+struct scratch_guard {
+    abieos_context* context;
+    ~scratch_guard() {
+        if (context)
+            context->scratch.trim(context->scratch_limit);
+    }
+};
+
 template <typename T, typename F>
 auto handle_exceptions(abieos_context* context, T errval, F f) noexcept -> decltype(f()) {
     if (!context)
@@ -81,7 +143,8 @@ extern "C" const char* abieos_get_bin_data(abieos_context* context) {
 extern "C" const char* abieos_get_bin_hex(abieos_context* context) {
     return handle_exceptions(context, nullptr, [&] {
         context->result_str.clear();
-        hex(context->result_bin.begin(), context->result_bin.end(), std::back_inserter(context->result_str));
+        append_hex(context->result_str, context->result_bin.data(),
+                   context->result_bin.data() + context->result_bin.size());
         return context->result_str.c_str();
     });
 }
@@ -98,6 +161,18 @@ extern "C" const char* abieos_name_to_string(abieos_context* context, uint64_t n
     });
 }
 
+extern "C" void abieos_names_to_strings(abieos_context* context, const uint64_t* names, size_t count, char* dest) {
+    if (!context || !names || !dest)
+        return;
+    eosio::names_to_slots(names, count, dest);
+}
+
+extern "C" void abieos_strings_to_names(abieos_context* context, const char* src, size_t count, uint64_t* dest) {
+    if (!context || !src || !dest)
+        return;
+    eosio::slots_to_names(src, count, dest);
+}
+
 extern "C" abieos_bool abieos_set_abi(abieos_context* context, uint64_t contract, const char* abi) {
     fix_null_str(abi);
     return handle_exceptions(context, false, [&]() {
@@ -127,11 +202,8 @@ extern "C" abieos_bool abieos_set_abi_bin(abieos_context* context, uint64_t cont
         from_bin(version, stream);
         if (!check_abi_version(version, error))
             return set_error(context, std::move(error));
-        abi_def def{};
-        stream = {data, size};
-        from_bin(def, stream);
         abieos::abi c;
-        convert(def, c);
+        convert(eosio::input_stream{data, size}, c);
         context->contracts.insert({name{contract}, std::move(c)});
         return true;
     });
@@ -142,7 +214,7 @@ extern "C" abieos_bool abieos_set_abi_hex(abieos_context* context, uint64_t cont
     return handle_exceptions(context, false, [&]() -> abieos_bool {
         std::vector<char> data;
         std::string error;
-        if (!unhex(error, hex, hex + strlen(hex), std::back_inserter(data))) {
+        if (!unhex(error, hex, data)) {
             if (!error.empty())
                 set_error(context, std::move(error));
             return false;
@@ -151,6 +223,60 @@ extern "C" abieos_bool abieos_set_abi_hex(abieos_context* context, uint64_t cont
     });
 }
 
+extern "C" abieos_bool abieos_save_snapshot(abieos_context* context) {
+    return handle_exceptions(context, false, [&] {
+        eosio::abi_snapshot snapshot;
+        for (auto& [contract, c] : context->contracts) {
+            auto& s = snapshot.contracts.emplace_back();
+            s.account = contract;
+            convert(c, s);
+        }
+        context->result_bin = convert_to_bin(snapshot);
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_load_snapshot(abieos_context* context, const char* data, size_t size) {
+    return handle_exceptions(context, false, [&] {
+        context->last_error = "snapshot parse error";
+        if (!data || !size)
+            return set_error(context, "no data");
+        eosio::input_stream stream{data, size};
+        uint32_t magic, version;
+        from_bin(magic, stream);
+        from_bin(version, stream);
+        if (magic != eosio::abi_snapshot_magic)
+            return set_error(context, "not an abi snapshot");
+        if (version != eosio::abi_snapshot_version)
+            return set_error(context, "unsupported abi snapshot version " + std::to_string(version));
+        eosio::abi_snapshot snapshot;
+        stream = {data, size};
+        from_bin(snapshot, stream);
+        if (stream.pos != stream.end)
+            throw std::runtime_error("Extra data");
+        std::vector<std::pair<name, abi>> contracts(snapshot.contracts.size());
+        for (size_t i = 0; i < contracts.size(); ++i) {
+            contracts[i].first = snapshot.contracts[i].account;
+            convert(snapshot.contracts[i], contracts[i].second);
+        }
+        for (auto& c : contracts)
+            context->contracts.insert(std::move(c));
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_get_abi_memory_usage(abieos_context* context, uint64_t contract,
+                                                   abieos_abi_memory_usage* usage) {
+    return handle_exceptions(context, false, [&] {
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        auto u = contract_it->second.memory_usage();
+        *usage = {u.types, u.fields, u.names, u.bytes};
+        return true;
+    });
+}
+
 extern "C" const char* abieos_get_type_for_action(abieos_context* context, uint64_t contract, uint64_t action) {
     return handle_exceptions(context, nullptr, [&] {
         auto contract_it = context->contracts.find(::abieos::name{contract});
@@ -216,6 +342,7 @@ extern "C" abieos_bool abieos_json_to_bin(abieos_context* context, uint64_t cont
                                           const char* json) {
     fix_null_str(type);
     fix_null_str(json);
+    scratch_guard guard{context};
     return handle_exceptions(context, false, [&] {
         context->last_error = "json parse error";
         auto contract_it = context->contracts.find(::abieos::name{contract});
@@ -224,9 +351,84 @@ extern "C" abieos_bool abieos_json_to_bin(abieos_context* context, uint64_t cont
         std::string error;
         auto t = contract_it->second.get_type(type);
         context->result_bin.clear();
-        context->result_bin = t->json_to_bin(json);
+        with_hooks(context, contract, pos_is_output_size, [&](auto&& hooks) {
+            json_to_bin(context->scratch, context->result_bin, t, json, hooks, context->bytes_encoding);
+        });
+        check_output_size(context, context->result_bin.size());
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_json_to_bin_begin(abieos_context* context, uint64_t contract, const char* type) {
+    fix_null_str(type);
+    if (!context)
+        return false;
+    context->incremental_json_to_bin.reset();
+    return handle_exceptions(context, false, [&] {
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        context->incremental_json_to_bin = std::make_unique<abieos::incremental_json_to_bin>(
+            contract_it->second.get_type(type), context->bytes_encoding);
+        context->incremental_contract = contract;
+        context->incremental_usage = {};
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_json_to_bin_append(abieos_context* context, const char* json, size_t size) {
+    if (!context)
+        return false;
+    if (!context->incremental_json_to_bin)
+        return set_error(context, "abieos_json_to_bin_begin was not called");
+    auto ok = handle_exceptions(context, false, [&] {
+        context->last_error = "json parse error";
+        with_hooks(context, context->incremental_contract, context->incremental_usage, pos_is_output_size,
+                   [&](auto&& hooks) { context->incremental_json_to_bin->append({json, json ? size : 0}, hooks); });
+        return true;
+    });
+    if (!ok)
+        context->incremental_json_to_bin.reset();
+    return ok;
+}
+
+extern "C" abieos_bool abieos_json_to_bin_finish(abieos_context* context) {
+    if (!context)
+        return false;
+    if (!context->incremental_json_to_bin)
+        return set_error(context, "abieos_json_to_bin_begin was not called");
+    auto ok = handle_exceptions(context, false, [&] {
+        context->last_error = "json parse error";
+        context->result_bin.clear();
+        with_hooks(context, context->incremental_contract, context->incremental_usage, pos_is_output_size,
+                   [&](auto&& hooks) { context->incremental_json_to_bin->finish(context->result_bin, hooks); });
+        check_output_size(context, context->result_bin.size());
         return true;
     });
+    context->incremental_json_to_bin.reset();
+    return ok;
+}
+
+extern "C" const char* abieos_json_to_hex(abieos_context* context, uint64_t contract, const char* type,
+                                          const char* json) {
+    fix_null_str(type);
+    fix_null_str(json);
+    scratch_guard guard{context};
+    return handle_exceptions(context, nullptr, [&]() -> const char* {
+        context->last_error = "json parse error";
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end()) {
+            set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+            return nullptr;
+        }
+        auto t = contract_it->second.get_type(type);
+        context->result_str.clear();
+        with_hooks(context, contract, pos_is_output_size, [&](auto&& hooks) {
+            json_to_hex(context->scratch, context->result_str, t, json, hooks, context->bytes_encoding);
+        });
+        check_output_size(context, context->result_str.size() / 2);
+        return context->result_str.c_str();
+    });
 }
 
 extern "C" abieos_bool abieos_json_to_bin_reorderable(abieos_context* context, uint64_t contract, const char* type,
@@ -240,8 +442,73 @@ extern "C" abieos_bool abieos_json_to_bin_reorderable(abieos_context* context, u
             return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
         std::string error;
         auto t = contract_it->second.get_type(type);
+        jvalue value;
+        json_to_jvalue(value, json);
+        context->result_bin.clear();
+        with_hooks(context, contract, pos_is_output_size, [&](auto&& hooks) {
+            json_to_bin(context->result_bin, t, value, hooks, context->bytes_encoding);
+        });
+        return true;
+    });
+}
+
+// The type of an action's data, for json_to_bin's bytes_type, from the object which holds the action
+const abi_type* action_data_type(abieos_context* context, const jobject& action) {
+    auto account = action.find("account");
+    auto act = action.find("name");
+    if (account == action.end() || act == action.end() || !std::holds_alternative<std::string>(account->second.value) ||
+        !std::holds_alternative<std::string>(act->second.value))
+        return nullptr;
+    name contract{eosio::hash_name(std::get<std::string>(account->second.value))};
+    name action_name{eosio::hash_name(std::get<std::string>(act->second.value))};
+    auto contract_it = context->contracts.find(contract);
+    if (contract_it == context->contracts.end())
+        throw std::runtime_error("contract \"" + eosio::name_to_string(contract.value) + "\" is not loaded");
+    auto& c = contract_it->second;
+    auto action_it = c.action_types.find(action_name);
+    if (action_it == c.action_types.end())
+        throw std::runtime_error("contract \"" + eosio::name_to_string(contract.value) + "\" does not have action \"" +
+                                 eosio::name_to_string(action_name.value) + "\"");
+    return c.get_type(action_it->second);
+}
+
+extern "C" abieos_bool abieos_transaction_json_to_bin(abieos_context* context, uint64_t contract, const char* type,
+                                                      const char* json, const char* chain_id,
+                                                      const char* context_free_data, size_t context_free_data_size,
+                                                      char* digest) {
+    fix_null_str(type);
+    fix_null_str(json);
+    return handle_exceptions(context, false, [&] {
+        context->last_error = "json parse error";
+        if (!chain_id || !digest || (!context_free_data && context_free_data_size))
+            return set_error(context, "no data");
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        auto t = contract_it->second.get_type(type);
+        jvalue value;
+        json_to_jvalue(value, json);
         context->result_bin.clear();
-        context->result_bin = t->json_to_bin_reorderable(json);
+        with_hooks(context, contract, pos_is_output_size, [&](auto&& hooks) {
+            json_to_bin(context->result_bin, t, value, hooks, context->bytes_encoding,
+                        [&](const jobject& parent) { return action_data_type(context, parent); });
+        });
+        // Nested action data gets its size inserted after the step which finishes it
+        check_output_size(context, context->result_bin.size());
+
+        using namespace abieos_sha256;
+        unsigned char context_free_data_hash[sha256_digest_size] = {};
+        sha256_state state;
+        if (context_free_data_size) {
+            sha256_init(&state);
+            sha256_update(&state, context_free_data, context_free_data_size);
+            sha256_digest(&state, context_free_data_hash);
+        }
+        sha256_init(&state);
+        sha256_update(&state, chain_id, 32);
+        sha256_update(&state, context->result_bin.data(), context->result_bin.size());
+        sha256_update(&state, context_free_data_hash, sizeof(context_free_data_hash));
+        sha256_digest(&state, (unsigned char*)digest);
         return true;
     });
 }
@@ -249,6 +516,7 @@ extern "C" abieos_bool abieos_json_to_bin_reorderable(abieos_context* context, u
 extern "C" const char* abieos_bin_to_json(abieos_context* context, uint64_t contract, const char* type,
                                           const char* data, size_t size) {
     fix_null_str(type);
+    scratch_guard guard{context};
     return handle_exceptions(context, nullptr, [&]() -> const char* {
         if (!data)
             size = 0;
@@ -261,20 +529,325 @@ extern "C" const char* abieos_bin_to_json(abieos_context* context, uint64_t cont
         }
         auto t = contract_it->second.get_type(type);
         eosio::input_stream bin{data, size};
-        context->result_str = t->bin_to_json(bin);
+        auto output_size = [&](size_t) { return context->scratch.bin.size(); };
+        with_hooks(context, contract, output_size, [&](auto&& hooks) {
+            bin_to_json(context->scratch, bin, t, context->result_str, hooks, context->bytes_encoding);
+        });
+        if (bin.pos != bin.end)
+            throw std::runtime_error("Extra data");
+        return context->result_str.c_str();
+    });
+}
+
+extern "C" abieos_bool abieos_bin_to_json_stream(abieos_context* context, uint64_t contract, const char* type,
+                                                 const char* data, size_t size, size_t chunk_size,
+                                                 abieos_write_fn write, void* user_data) {
+    fix_null_str(type);
+    scratch_guard guard{context};
+    return handle_exceptions(context, false, [&] {
+        if (!data)
+            size = 0;
+        context->last_error = "binary decode error";
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        if (!write)
+            return set_error(context, "no write function");
+        if (!chunk_size)
+            chunk_size = 64 * 1024;
+        auto t = contract_it->second.get_type(type);
+        eosio::input_stream bin{data, size};
+        size_t written = 0;
+        auto output = [&](const char* chunk, size_t chunk_size) {
+            if (!write(user_data, chunk, chunk_size))
+                throw std::runtime_error("write function failed");
+            written += chunk_size;
+        };
+        auto output_size = [&](size_t) { return written + context->scratch.bin.size(); };
+        with_hooks(context, contract, output_size, [&](auto&& hooks) {
+            bin_to_json(context->scratch, bin, t, chunk_size, output, hooks, context->bytes_encoding);
+        });
+        if (bin.pos != bin.end)
+            throw std::runtime_error("Extra data");
+        return true;
+    });
+}
+
+extern "C" const char* abieos_bin_to_json_parallel(abieos_context* context, uint64_t contract, const char* type,
+                                                   const char* data, size_t size, uint32_t num_threads) {
+    fix_null_str(type);
+    scratch_guard guard{context};
+    return handle_exceptions(context, nullptr, [&]() -> const char* {
+        if (!data)
+            size = 0;
+        context->last_error = "binary decode error";
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            throw std::runtime_error("contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        if (!num_threads)
+            num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        auto t = contract_it->second.get_type(type);
+        eosio::input_stream bin{data, size};
+        auto output_size = [&](size_t) { return context->scratch.bin.size(); };
+        with_hooks(context, contract, output_size, [&](auto&& hooks) {
+            bin_to_json_parallel(context->scratch, bin, t, context->result_str, num_threads, hooks,
+                                 context->bytes_encoding);
+        });
+        check_output_size(context, context->result_str.size());
         if (bin.pos != bin.end)
             throw std::runtime_error("Extra data");
         return context->result_str.c_str();
     });
 }
 
+extern "C" abieos_bool abieos_bin_to_document(abieos_context* context, uint64_t contract, const char* type,
+                                              const char* data, size_t size, abieos_document_format format) {
+    fix_null_str(type);
+    return handle_exceptions(context, false, [&] {
+        if (!data)
+            size = 0;
+        context->last_error = "binary decode error";
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        if (format != abieos_document_cbor && format != abieos_document_msgpack)
+            return set_error(context, "unknown document format");
+        auto t = contract_it->second.get_type(type);
+        eosio::input_stream bin{data, size};
+        context->result_bin.clear();
+        auto output_size = [&](size_t) { return context->result_bin.size(); };
+        with_hooks(context, contract, output_size, [&](auto&& hooks) {
+            bin_to_document(bin, t, format == abieos_document_cbor ? document_format::cbor : document_format::msgpack,
+                            context->result_bin, hooks);
+        });
+        if (bin.pos != bin.end)
+            throw std::runtime_error("Extra data");
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_transcode_bin(abieos_context* context, uint64_t from_contract, const char* from_type,
+                                            uint64_t to_contract, const char* to_type, const char* data, size_t size) {
+    fix_null_str(from_type);
+    fix_null_str(to_type);
+    return handle_exceptions(context, false, [&] {
+        if (!data)
+            size = 0;
+        context->last_error = "binary decode error";
+        auto from_it = context->contracts.find(::abieos::name{from_contract});
+        if (from_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(from_contract) + "\" is not loaded");
+        auto to_it = context->contracts.find(::abieos::name{to_contract});
+        if (to_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(to_contract) + "\" is not loaded");
+        auto plan = context->transcoder.get_plan(from_it->second.get_type(from_type), to_it->second.get_type(to_type));
+        eosio::input_stream bin{data, size};
+        context->result_bin.clear();
+        auto output_size = [&](size_t) { return context->result_bin.size(); };
+        with_hooks(context, from_contract, output_size, [&](auto&& hooks) {
+            transcoder::transcode(plan, bin, context->result_bin, true, hooks);
+        });
+        if (bin.pos != bin.end)
+            throw std::runtime_error("Extra data");
+        return true;
+    });
+}
+
+extern "C" int abieos_check_bin(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                                size_t size) {
+    fix_null_str(type);
+    auto t = handle_exceptions(context, (const abi_type*)nullptr, [&]() -> const abi_type* {
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end()) {
+            set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+            return nullptr;
+        }
+        return contract_it->second.get_type(type);
+    });
+    if (!t)
+        return -1;
+    if (!data)
+        size = 0;
+    eosio::input_stream bin{data, size};
+    auto error = check_bin(bin, t);
+    if (!error && bin.pos != bin.end) {
+        context->last_error = "Extra data";
+        return int(eosio::stream_error::underrun);
+    }
+    if (!error)
+        return 0;
+    // The messages are string literals, so this doesn't allocate
+    context->last_error = error.message().data();
+    if (error.abi != eosio::abi_error::no_error)
+        return 256 + int(error.abi);
+    return int(error.stream);
+}
+
+extern "C" abieos_bool abieos_bin_to_key(abieos_context* context, uint64_t contract, const char* type,
+                                         const char* data, size_t size) {
+    fix_null_str(type);
+    return handle_exceptions(context, false, [&] {
+        if (!data)
+            size = 0;
+        context->last_error = "binary decode error";
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        auto t = contract_it->second.get_type(type);
+        eosio::input_stream bin{data, size};
+        context->result_bin.clear();
+        auto output_size = [&](size_t) { return context->result_bin.size(); };
+        with_hooks(context, contract, output_size,
+                   [&](auto&& hooks) { bin_to_key(bin, t, context->result_bin, true, hooks); });
+        if (bin.pos != bin.end)
+            throw std::runtime_error("Extra data");
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_json_to_key(abieos_context* context, uint64_t contract, const char* type,
+                                          const char* json) {
+    fix_null_str(type);
+    fix_null_str(json);
+    scratch_guard guard{context};
+    return handle_exceptions(context, false, [&] {
+        context->last_error = "json parse error";
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        auto t = contract_it->second.get_type(type);
+        auto& data = context->scratch.input;
+        data.clear();
+        context->result_bin.clear();
+        budget_usage usage;
+        with_hooks(context, contract, usage, pos_is_output_size, [&](auto&& hooks) {
+            json_to_bin(context->scratch, data, t, json, hooks, context->bytes_encoding);
+        });
+        check_output_size(context, data.size());
+        eosio::input_stream bin{data};
+        auto output_size = [&](size_t) { return context->result_bin.size(); };
+        with_hooks(context, contract, usage, output_size,
+                   [&](auto&& hooks) { bin_to_key(bin, t, context->result_bin, true, hooks); });
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_bin_to_key_batch(abieos_context* context, uint64_t contract, const char* type,
+                                               const char* data, size_t size) {
+    fix_null_str(type);
+    return handle_exceptions(context, false, [&] {
+        if (!data)
+            size = 0;
+        context->last_error = "binary decode error";
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        auto t = contract_it->second.get_type(type);
+        eosio::input_stream bin{data, size};
+        std::vector<char> keys;
+        std::vector<size_t> ends;
+        auto output_size = [&](size_t) { return keys.size(); };
+        with_hooks(context, contract, output_size, [&](auto&& hooks) {
+            while (bin.pos != bin.end) {
+                auto start = bin.pos;
+                bin_to_key(bin, t, keys, false, hooks);
+                if (bin.pos == start)
+                    throw std::runtime_error("type \"" + std::string(type) + "\" has an empty binary form");
+                ends.push_back(keys.size());
+            }
+        });
+        context->result_bin.clear();
+        context->result_bin.reserve(keys.size() + 5 * (ends.size() + 1));
+        eosio::push_varuint32(context->result_bin, ends.size());
+        size_t pos = 0;
+        for (auto end : ends) {
+            eosio::push_varuint32(context->result_bin, end - pos);
+            context->result_bin.insert(context->result_bin.end(), keys.begin() + pos, keys.begin() + end);
+            pos = end;
+        }
+        return true;
+    });
+}
+
+extern "C" abieos_bool abieos_bin_to_columns(abieos_context* context, uint64_t contract, const char* type,
+                                             const char* const* rows, const size_t* sizes, size_t num_rows) {
+    fix_null_str(type);
+    return handle_exceptions(context, false, [&] {
+        context->columns.reset();
+        context->last_error = "binary decode error";
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        column_set columns{contract_it->second.get_type(type)};
+        auto output_size = [&](size_t) {
+            size_t size = 0;
+            for (auto& c : columns.columns)
+                size += c.data.size();
+            return size;
+        };
+        with_hooks(context, contract, output_size, [&](auto&& hooks) {
+            for (size_t i = 0; i < num_rows; ++i)
+                columns.add_row({rows[i], rows[i] + sizes[i]}, hooks);
+        });
+        context->columns.emplace(std::move(columns));
+        return true;
+    });
+}
+
+extern "C" uint32_t abieos_get_column_count(abieos_context* context) {
+    if (!context)
+        return 0;
+    return context->columns ? context->columns->columns.size() : 0;
+}
+
+extern "C" abieos_bool abieos_get_column(abieos_context* context, uint32_t index, abieos_column* column) {
+    if (!context)
+        return false;
+    if (!column)
+        return set_error(context, "column is null");
+    if (!context->columns || index >= context->columns->columns.size())
+        return set_error(context, "column index out of range");
+    auto& c = context->columns->columns[index];
+    column->name = c.name.c_str();
+    column->type = c.type->name.c_str();
+    column->width = c.width;
+    column->num_rows = context->columns->num_rows;
+    column->data = c.data.data();
+    column->data_size = c.data.size();
+    column->offsets = c.width ? nullptr : c.offsets.data();
+    column->validity = c.nullable ? c.validity.data() : nullptr;
+    return true;
+}
+
+extern "C" abieos_bool abieos_random_bin(abieos_context* context, uint64_t contract, const char* type, uint64_t seed,
+                                         const abieos_random_options* options) {
+    fix_null_str(type);
+    return handle_exceptions(context, false, [&] {
+        auto contract_it = context->contracts.find(::abieos::name{contract});
+        if (contract_it == context->contracts.end())
+            return set_error(context, "contract \"" + eosio::name_to_string(contract) + "\" is not loaded");
+        auto t = contract_it->second.get_type(type);
+        random_bin_options opts;
+        if (options) {
+            opts.max_array_size = options->max_array_size;
+            opts.max_string_size = options->max_string_size;
+            opts.max_depth = options->max_depth;
+        }
+        std::mt19937_64 rng{seed};
+        context->result_bin.clear();
+        random_bin(rng, t, context->result_bin, opts);
+        return true;
+    });
+}
+
 extern "C" const char* abieos_hex_to_json(abieos_context* context, uint64_t contract, const char* type,
                                           const char* hex) {
     fix_null_str(hex);
+    scratch_guard guard{context};
     return handle_exceptions(context, nullptr, [&]() -> const char* {
-        std::vector<char> data;
+        auto& data = context->scratch.input;
         std::string error;
-        if (!unhex(error, hex, hex + strlen(hex), std::back_inserter(data))) {
+        if (!unhex(error, hex, data)) {
             if (!error.empty())
                 set_error(context, std::move(error));
             return nullptr;
@@ -283,6 +856,69 @@ extern "C" const char* abieos_hex_to_json(abieos_context* context, uint64_t cont
     });
 }
 
+extern "C" abieos_bool abieos_set_bytes_encoding(abieos_context* context, abieos_bytes_encoding encoding) {
+    if (!context)
+        return false;
+    switch (encoding) {
+    case abieos_bytes_hex: context->bytes_encoding = bytes_encoding::hex; return true;
+    case abieos_bytes_base64: context->bytes_encoding = bytes_encoding::base64; return true;
+    case abieos_bytes_base64url: context->bytes_encoding = bytes_encoding::base64url; return true;
+    }
+    return set_error(context, "unknown bytes encoding");
+}
+
+extern "C" void abieos_set_scratch_limit(abieos_context* context, size_t limit) {
+    if (!context)
+        return;
+    context->scratch_limit = limit;
+    context->scratch.trim(limit);
+}
+
+extern "C" size_t abieos_get_scratch_size(abieos_context* context) {
+    if (!context)
+        return 0;
+    return context->scratch.capacity();
+}
+
+extern "C" void abieos_set_budget(abieos_context* context, uint64_t max_steps, uint64_t max_output_size,
+                                  uint64_t time_limit_ns) {
+    if (!context)
+        return;
+    context->budget.max_steps = max_steps;
+    context->budget.max_output_size = max_output_size;
+    context->budget.time_limit = std::chrono::nanoseconds(time_limit_ns);
+}
+
+extern "C" void abieos_set_profiling(abieos_context* context, abieos_bool enable) {
+    if (!context)
+        return;
+    context->profiling = enable;
+    if (enable)
+        context->profile.clear();
+}
+
+extern "C" const char* abieos_get_profile(abieos_context* context) {
+    return handle_exceptions(context, nullptr, [&] {
+        std::vector<std::pair<const std::pair<name, std::string>*, const type_profile*>> rows;
+        for (auto& [key, p] : context->profile)
+            rows.push_back({&key, &p});
+        std::stable_sort(rows.begin(), rows.end(),
+                         [](auto& a, auto& b) { return a.second->cycles > b.second->cycles; });
+        std::string& result = context->result_str;
+        result = "[";
+        for (auto& [key, p] : rows) {
+            if (result.size() > 1)
+                result += ',';
+            result += "{\"contract\":" + eosio::convert_to_json(key->first) +
+                      ",\"type\":" + eosio::convert_to_json(key->second) +
+                      ",\"count\":" + std::to_string(p->count) + ",\"bytes\":" + std::to_string(p->bytes) +
+                      ",\"cycles\":" + std::to_string(p->cycles) + "}";
+        }
+        result += "]";
+        return result.c_str();
+    });
+}
+
 extern "C" abieos_bool abieos_abi_json_to_bin(abieos_context* context, const char* abi_json) {
     fix_null_str(abi_json);
     return handle_exceptions(context, false, [&] {
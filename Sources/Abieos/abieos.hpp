@@ -8,6 +8,7 @@
 #include "eosio/reflection.hpp"
 #include "eosio/to_bin.hpp"
 #include "eosio/to_json.hpp"
+#include "eosio/to_key.hpp"
 #include "eosio/abi.hpp"
 #include "eosio/operators.hpp"
 #include "eosio/bytes.hpp"
@@ -26,9 +27,15 @@
 #pragma clang diagnostic ignored "-W#warnings"
 #endif
 
+#include <chrono>
 #include <ctime>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <map>
 #include <optional>
+#include <random>
+#include <thread>
 #include <variant>
 #include <vector>
 
@@ -47,15 +54,11 @@ namespace abieos {
 using eosio::from_bin;
 using eosio::to_bin;
 
-inline constexpr bool trace_json_to_jvalue_event = false;
-inline constexpr bool trace_json_to_jvalue = false;
-inline constexpr bool trace_jvalue_to_bin = false;
-inline constexpr bool trace_json_to_bin = false;
-inline constexpr bool trace_json_to_bin_event = false;
-inline constexpr bool trace_bin_to_json = false;
-
 inline constexpr size_t max_stack_size = 128;
 
+// bin_to_json_parallel gives each thread at least this many bytes of array elements
+inline constexpr size_t min_parallel_chunk_size = 64 * 1024;
+
 // Pseudo objects never exist, except in serialized form
 struct pseudo_optional;
 struct pseudo_extension;
@@ -110,6 +113,44 @@ ABIEOS_NODISCARD bool unhex(std::string& error, SrcIt begin, SrcIt end, DestIt d
     return true;
 }
 
+// Appends the hex form of [begin, end) to dest. Same output as hex(), but dest grows once.
+inline void append_hex(std::string& dest, const char* begin, const char* end) {
+    static constexpr char digits[] = "0123456789ABCDEF";
+    auto pos = dest.size();
+    dest.resize(pos + 2 * (end - begin));
+    auto* out = dest.data() + pos;
+    for (; begin != end; ++begin) {
+        *out++ = digits[uint8_t(*begin) >> 4];
+        *out++ = digits[uint8_t(*begin) & 0xf];
+    }
+}
+
+// Like unhex(), but replaces the contents of dest, which is resized once
+ABIEOS_NODISCARD inline bool unhex(std::string& error, std::string_view hex, std::vector<char>& dest) {
+    static constexpr auto values = [] {
+        std::array<int8_t, 256> result{};
+        for (auto& v : result)
+            v = -1;
+        for (int i = 0; i < 10; ++i)
+            result['0' + i] = i;
+        for (int i = 0; i < 6; ++i)
+            result['a' + i] = result['A' + i] = 10 + i;
+        return result;
+    }();
+    if (hex.size() % 2)
+        return set_error(error, "expected hex string");
+    dest.resize(hex.size() / 2);
+    auto* in = (const uint8_t*)hex.data();
+    for (auto& out : dest) {
+        auto h = values[*in++];
+        auto l = values[*in++];
+        if ((h | l) < 0)
+            return set_error(error, "expected hex string");
+        out = (h << 4) | l;
+    }
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // stream events
 ///////////////////////////////////////////////////////////////////////////////
@@ -184,7 +225,7 @@ struct json_reader_handler : public rapidjson::BaseReaderHandler<rapidjson::UTF8
 
 struct jvalue;
 using jarray = std::vector<jvalue>;
-using jobject = std::map<std::string, jvalue>;
+using jobject = std::map<std::string, jvalue, std::less<>>;
 
 struct jvalue {
     std::variant<std::nullptr_t, bool, std::string, jobject, jarray> value;
@@ -213,6 +254,20 @@ struct jvalue_to_bin_stack_entry {
     int position = -1;
 };
 
+// A bytes value which jvalue_to_bin_state is serializing from an object. It's done once the stack is back to depth.
+struct nested_bytes {
+    size_t position = 0;
+    size_t depth = 0;
+    bool skipped_extension = false;
+};
+
+// How json holds bytes values
+enum class bytes_encoding {
+    hex,
+    base64,    // RFC 4648, with padding; input may omit it
+    base64url, // RFC 4648 url-safe alphabet, without padding; input may have it
+};
+
 struct json_to_bin_stack_entry {
     const abi_type* type = nullptr;
     bool allow_extensions = false;
@@ -240,6 +295,26 @@ struct jvalue_to_bin_state {
     const jvalue* received_value = nullptr;
     std::vector<jvalue_to_bin_stack_entry> stack{};
     bool skipped_extension = false;
+    bytes_encoding encoding = bytes_encoding::hex;
+
+    // Gives the type of a bytes value which json has as an object, such as an action's data, from the object which
+    // holds the bytes field. If it's unset or returns null, bytes must be a string.
+    std::function<const abi_type*(const jobject& parent)> bytes_type{};
+    std::vector<nested_bytes> nested{};
+
+    // Puts its size in front of each nested bytes value which is done
+    void finish_nested_bytes() {
+        while (!nested.empty() && stack.size() == nested.back().depth) {
+            auto& n = nested.back();
+            auto& data = writer.data;
+            char size[5];
+            eosio::fixed_buf_stream size_stream{size, sizeof(size)};
+            eosio::varuint32_to_bin(data.size() - n.position, size_stream);
+            data.insert(data.begin() + n.position, size, size_stream.pos);
+            skipped_extension = n.skipped_extension;
+            nested.pop_back();
+        }
+    }
 
     bool get_bool() const {
       auto* b = std::get_if<bool>(&received_value->value);
@@ -267,9 +342,20 @@ struct json_to_bin_state : eosio::json_token_stream {
     std::vector<size_insertion> size_insertions{};
     std::vector<json_to_bin_stack_entry> stack{};
     bool skipped_extension = false;
+    bytes_encoding encoding = bytes_encoding::hex;
 
     explicit json_to_bin_state(char* in, eosio::vector_stream& out)
       : eosio::json_token_stream(in), writer(out) {}
+
+    // See json_token_stream::reset
+    bool reset(char* in) {
+        if (!json_token_stream::reset(in))
+            return false;
+        size_insertions.clear();
+        stack.clear();
+        skipped_extension = false;
+        return true;
+    }
 };
 
 struct bin_to_json_state {
@@ -277,11 +363,318 @@ struct bin_to_json_state {
     eosio::vector_stream& writer;
     std::vector<bin_to_json_stack_entry> stack{};
     bool skipped_extension = false;
+    bytes_encoding encoding = bytes_encoding::hex;
 
     bin_to_json_state(eosio::input_stream& bin, eosio::vector_stream& writer)
         : bin{bin}, writer{writer} {}
 };
 
+// Buffers which conversions reuse from call to call. Once they have grown to fit the values being converted,
+// converting similar values doesn't allocate.
+struct scratch_buffers {
+    std::string json{};       // json_to_bin: copy of the input, which the parser modifies
+    std::vector<char> bin{};  // json_to_bin: output before sizes are inserted; bin_to_json: output
+    std::vector<char> input{};
+    eosio::vector_stream bin_stream{bin};
+    std::optional<json_to_bin_state> json_state{};
+    std::vector<bin_to_json_stack_entry> bin_to_json_stack{};
+
+    scratch_buffers() = default;
+    scratch_buffers(const scratch_buffers&) = delete;
+    scratch_buffers& operator=(const scratch_buffers&) = delete;
+
+    // Copies json into the buffers and returns a state which parses it
+    json_to_bin_state& start_json_to_bin(std::string_view json) {
+        this->json.assign(json.data(), json.size());
+        this->json.append(3, 0);
+        bin.clear();
+        if (!json_state || !json_state->reset(this->json.data()))
+            json_state.emplace(this->json.data(), bin_stream);
+        return *json_state;
+    }
+
+    // Bytes held. This doesn't count the parser's internal stack, which is small.
+    size_t capacity() const {
+        size_t result = json.capacity() + bin.capacity() + input.capacity() +
+                        bin_to_json_stack.capacity() * sizeof(bin_to_json_stack_entry);
+        if (json_state)
+            result += json_state->size_insertions.capacity() * sizeof(size_insertion) +
+                      json_state->stack.capacity() * sizeof(json_to_bin_stack_entry);
+        return result;
+    }
+
+    // Releases everything if more than limit bytes are held
+    void trim(size_t limit) {
+        if (capacity() <= limit)
+            return;
+        std::string{}.swap(json);
+        std::vector<char>{}.swap(bin);
+        std::vector<char>{}.swap(input);
+        json_state.reset();
+        std::vector<bin_to_json_stack_entry>{}.swap(bin_to_json_stack);
+    }
+};
+
+enum class document_format {
+    cbor,
+    msgpack,
+};
+
+// Writes cbor (RFC 8949) or msgpack values
+struct document_writer {
+    document_format format;
+    std::vector<char>& out;
+
+    void write_null() { out.push_back(format == document_format::cbor ? char(0xf6) : char(0xc0)); }
+
+    void write_bool(bool v) {
+        if (format == document_format::cbor)
+            out.push_back(v ? char(0xf5) : char(0xf4));
+        else
+            out.push_back(v ? char(0xc3) : char(0xc2));
+    }
+
+    void write_uint(uint64_t v) {
+        if (format == document_format::cbor)
+            return write_head(0, v);
+        if (v < 0x80)
+            out.push_back(char(v));
+        else
+            write_sized(0xcc, 0xcd, 0xce, 0xcf, v);
+    }
+
+    void write_int(int64_t v) {
+        if (v >= 0)
+            return write_uint(v);
+        if (format == document_format::cbor)
+            return write_head(1, uint64_t(-1 - v));
+        if (v >= -32)
+            out.push_back(char(v));
+        else if (v >= INT8_MIN)
+            write_be(0xd0, uint8_t(v), 1);
+        else if (v >= INT16_MIN)
+            write_be(0xd1, uint16_t(v), 2);
+        else if (v >= INT32_MIN)
+            write_be(0xd2, uint32_t(v), 4);
+        else
+            write_be(0xd3, uint64_t(v), 8);
+    }
+
+    void write_float(float v) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        write_be(format == document_format::cbor ? 0xfa : 0xca, bits, 4);
+    }
+
+    void write_double(double v) {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        write_be(format == document_format::cbor ? 0xfb : 0xcb, bits, 8);
+    }
+
+    void write_string(std::string_view v) {
+        if (format == document_format::cbor)
+            write_head(3, v.size());
+        else if (v.size() < 32)
+            out.push_back(char(0xa0 | v.size()));
+        else
+            write_sized(0xd9, 0xda, 0xdb, 0, v.size());
+        out.insert(out.end(), v.begin(), v.end());
+    }
+
+    void write_bytes(const char* data, size_t size) {
+        if (format == document_format::cbor)
+            write_head(2, size);
+        else
+            write_sized(0xc4, 0xc5, 0xc6, 0, size);
+        out.insert(out.end(), data, data + size);
+    }
+
+    void begin_array(uint32_t size) {
+        if (format == document_format::cbor)
+            write_head(4, size);
+        else if (size < 16)
+            out.push_back(char(0x90 | size));
+        else
+            write_sized(0, 0xdc, 0xdd, 0, size);
+    }
+
+    // Begins a map with up to max_size entries and returns where its header is. The header is as wide as max_size
+    // needs, so that set_map_size can change the size in place.
+    size_t begin_map(uint32_t max_size) {
+        size_t pos = out.size();
+        if (format == document_format::cbor) {
+            write_head(5, max_size);
+        } else if (max_size < 16) {
+            out.push_back(char(0x80 | max_size));
+        } else {
+            write_sized(0, 0xde, 0xdf, 0, max_size);
+        }
+        return pos;
+    }
+
+    void set_map_size(size_t header, uint32_t size) {
+        auto* p = (uint8_t*)out.data() + header;
+        int width; // bytes after the prefix
+        if (format == document_format::cbor)
+            width = (*p & 0x1f) < 24 ? 0 : 1 << ((*p & 0x1f) - 24);
+        else
+            width = *p < 0x90 ? 0 : *p == 0xde ? 2 : 4;
+        if (!width)
+            *p = (*p & (format == document_format::cbor ? 0xe0 : 0xf0)) | size;
+        for (int i = width; i > 0; --i, size >>= 8)
+            p[i] = uint8_t(size);
+    }
+
+  private:
+    void write_be(uint8_t prefix, uint64_t v, int size) {
+        out.push_back(char(prefix));
+        for (int i = size - 1; i >= 0; --i)
+            out.push_back(char(v >> (8 * i)));
+    }
+
+    // cbor: major type and argument, in the shortest form
+    void write_head(uint8_t major, uint64_t v) {
+        if (v < 24)
+            out.push_back(char((major << 5) | v));
+        else if (v <= 0xff)
+            write_be((major << 5) | 24, v, 1);
+        else if (v <= 0xffff)
+            write_be((major << 5) | 25, v, 2);
+        else if (v <= 0xffffffff)
+            write_be((major << 5) | 26, v, 4);
+        else
+            write_be((major << 5) | 27, v, 8);
+    }
+
+    // msgpack: the shortest of the 1, 2, 4 and 8 byte forms which has a prefix
+    void write_sized(uint8_t prefix8, uint8_t prefix16, uint8_t prefix32, uint8_t prefix64, uint64_t v) {
+        if (prefix8 && v <= 0xff)
+            write_be(prefix8, v, 1);
+        else if (v <= 0xffff)
+            write_be(prefix16, v, 2);
+        else if (!prefix64 || v <= 0xffffffff)
+            write_be(prefix32, v, 4);
+        else
+            write_be(prefix64, v, 8);
+    }
+};
+
+struct bin_to_document_stack_entry {
+    const abi_type* type = nullptr;
+    bool allow_extensions = false;
+    int position = -1;
+    uint32_t size = 0;  // arrays: number of elements; structs: number of fields written
+    size_t header = 0;  // structs: where the map header is
+};
+
+struct bin_to_document_state {
+    eosio::input_stream& bin;
+    document_writer writer;
+    std::vector<bin_to_document_stack_entry> stack{};
+    std::vector<char> text{};
+
+    bin_to_document_state(eosio::input_stream& bin, document_format format, std::vector<char>& out)
+        : bin{bin}, writer{format, out} {}
+};
+
+struct bin_to_key_state {
+    eosio::input_stream& bin;
+    eosio::vector_stream& writer;
+    std::vector<bin_to_json_stack_entry> stack{};
+
+    bin_to_key_state(eosio::input_stream& bin, eosio::vector_stream& writer)
+        : bin{bin}, writer{writer} {}
+};
+
+struct skip_bin_state {
+    eosio::input_stream& bin;
+    std::vector<bin_to_json_stack_entry> stack{};
+
+    explicit skip_bin_state(eosio::input_stream& bin) : bin{bin} {}
+};
+
+// Error from the non-throwing functions. At most one of the codes is set.
+struct error_code {
+    eosio::stream_error stream = eosio::stream_error::no_error;
+    eosio::abi_error abi = eosio::abi_error::no_error;
+
+    explicit operator bool() const { return stream != eosio::stream_error::no_error || abi != eosio::abi_error::no_error; }
+    std::string_view message() const {
+        return abi != eosio::abi_error::no_error ? eosio::convert_abi_error(abi) : eosio::convert_stream_error(stream);
+    }
+};
+
+// Like skip_bin_state, but every operation returns false and records the error instead of throwing. The stack never
+// grows past its reserved size, so only running out of memory in the constructor can throw.
+struct check_bin_state {
+    eosio::input_stream& bin;
+    std::vector<bin_to_json_stack_entry> stack{};
+    error_code error{};
+
+    explicit check_bin_state(eosio::input_stream& bin) : bin{bin} { stack.reserve(max_stack_size + 2); }
+
+    ABIEOS_NODISCARD bool fail(eosio::stream_error e) {
+        error.stream = e;
+        return false;
+    }
+    ABIEOS_NODISCARD bool push(const bin_to_json_stack_entry& entry) {
+        if (stack.size() == stack.capacity()) {
+            error.abi = eosio::abi_error::recursion_limit_reached;
+            return false;
+        }
+        stack.push_back(entry);
+        return true;
+    }
+    ABIEOS_NODISCARD bool skip(uint64_t size) {
+        if (size > bin.remaining())
+            return fail(eosio::stream_error::overrun);
+        bin.pos += size;
+        return true;
+    }
+    // Same encoding limits as varuint32_from_bin and varuint64_from_bin
+    template <typename T, int max_shift>
+    ABIEOS_NODISCARD bool read_varuint(T& dest) {
+        dest = 0;
+        int shift = 0;
+        uint8_t b = 0;
+        do {
+            if (shift >= max_shift)
+                return fail(eosio::stream_error::invalid_varuint_encoding);
+            if (bin.pos == bin.end)
+                return fail(eosio::stream_error::overrun);
+            b = *bin.pos++;
+            dest |= T(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        return true;
+    }
+    ABIEOS_NODISCARD bool read_varuint32(uint32_t& dest) { return read_varuint<uint32_t, 35>(dest); }
+    ABIEOS_NODISCARD bool read_varuint64(uint64_t& dest) { return read_varuint<uint64_t, 70>(dest); }
+};
+
+struct random_bin_options {
+    uint32_t max_array_size = 4;
+    uint32_t max_string_size = 32;  // also bytes
+    uint32_t max_depth = 8;         // deeper optionals are absent and deeper arrays are empty
+    double optional_chance = 0.5;   // chance that an optional is present
+    double extension_chance = 0.5;  // chance that trailing binary extensions are present
+};
+
+struct random_bin_state {
+    std::mt19937_64& rng;
+    eosio::vector_stream& writer;
+    const random_bin_options& options;
+    std::vector<bin_to_json_stack_entry> stack{};
+
+    random_bin_state(std::mt19937_64& rng, eosio::vector_stream& writer, const random_bin_options& options)
+        : rng{rng}, writer{writer}, options{options} {}
+
+    // std::uniform_int_distribution differs between standard libraries; these don't
+    uint64_t below(uint64_t n) { return n ? rng() % n : 0; }
+    bool chance(double p) { return (rng() >> 11) * 0x1.0p-53 < p; }
+};
+
 }
 
 namespace eosio {
@@ -293,6 +686,18 @@ struct abi_serializer {
                                           bool start) const = 0;
   virtual void bin_to_json(::abieos::bin_to_json_state& state, bool allow_extensions, const abi_type* type,
                                           bool start) const = 0;
+  virtual void skip_bin(::abieos::skip_bin_state& state, bool allow_extensions, const abi_type* type,
+                                          bool start) const = 0;
+  virtual void bin_to_key(::abieos::bin_to_key_state& state, bool allow_extensions, const abi_type* type,
+                                          bool start) const = 0;
+  virtual void random_bin(::abieos::random_bin_state& state, bool allow_extensions, const abi_type* type,
+                                          bool start) const = 0;
+  virtual bool check_bin(::abieos::check_bin_state& state, bool allow_extensions, const abi_type* type,
+                                          bool start) const noexcept = 0;
+  virtual void bin_to_document(::abieos::bin_to_document_state& state, bool allow_extensions, const abi_type* type,
+                                          bool start) const = 0;
+  // Size of every value of the type in binary form; 0 if it varies.
+  virtual size_t fixed_bin_size() const = 0;
 };
 
 }
@@ -315,6 +720,7 @@ void json_to_bin(T*, State& state, bool allow_extensions, const abi_type*,
 template <typename State>
 void json_to_bin(std::string*, jvalue_to_bin_state& state, bool allow_extensions, const abi_type*,
                                 bool start);
+void json_to_bin(eosio::bytes*, jvalue_to_bin_state& state, bool allow_extensions, const abi_type* type, bool start);
 
 void json_to_bin(pseudo_object*, jvalue_to_bin_state& state, bool allow_extensions,
                                 const abi_type* type, bool start);
@@ -341,6 +747,61 @@ void bin_to_json(pseudo_array*, bin_to_json_state& state, bool allow_extensions,
 void bin_to_json(pseudo_variant*, bin_to_json_state& state, bool allow_extensions,
                                 const abi_type* type, bool start);
 
+void skip_bin(pseudo_optional*, skip_bin_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+void skip_bin(pseudo_extension*, skip_bin_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+void skip_bin(pseudo_object*, skip_bin_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void skip_bin(pseudo_array*, skip_bin_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void skip_bin(pseudo_variant*, skip_bin_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+
+void bin_to_key(pseudo_optional*, bin_to_key_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+void bin_to_key(pseudo_extension*, bin_to_key_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+void bin_to_key(pseudo_object*, bin_to_key_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void bin_to_key(pseudo_array*, bin_to_key_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void bin_to_key(pseudo_variant*, bin_to_key_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+
+void random_bin(pseudo_optional*, random_bin_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+void random_bin(pseudo_extension*, random_bin_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+void random_bin(pseudo_object*, random_bin_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void random_bin(pseudo_array*, random_bin_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void random_bin(pseudo_variant*, random_bin_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+
+bool check_bin(pseudo_optional*, check_bin_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+bool check_bin(pseudo_extension*, check_bin_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+bool check_bin(pseudo_object*, check_bin_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+bool check_bin(pseudo_array*, check_bin_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+bool check_bin(pseudo_variant*, check_bin_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+
+void bin_to_document(pseudo_optional*, bin_to_document_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+void bin_to_document(pseudo_extension*, bin_to_document_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+void bin_to_document(pseudo_object*, bin_to_document_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void bin_to_document(pseudo_array*, bin_to_document_state& state, bool allow_extensions, const abi_type* type,
+                                bool start);
+void bin_to_document(pseudo_variant*, bin_to_document_state& state, bool allow_extensions,
+                                const abi_type* type, bool start);
+
 ///////////////////////////////////////////////////////////////////////////////
 // serializable types
 ///////////////////////////////////////////////////////////////////////////////
@@ -350,8 +811,16 @@ using eosio::bytes;
 template <typename State>
 void json_to_bin(bytes*, State& state, bool, const abi_type*, bool start) {
     auto s = state.get_string();;
-    if (trace_json_to_bin)
-        printf("%*sbytes (%d hex digits)\n", int(state.stack.size() * 4), "", int(s.size()));
+    if (state.encoding != bytes_encoding::hex) {
+        auto size = eosio::base64_decoded_size(s);
+        eosio::check(size >= 0, eosio::convert_json_error(eosio::from_json_error::expected_base64_string));
+        eosio::varuint32_to_bin(size, state.writer);
+        auto& data = state.writer.data;
+        data.resize(data.size() + size);
+        eosio::check(eosio::unbase64(data.data() + data.size() - size, s, state.encoding == bytes_encoding::base64url),
+            eosio::convert_json_error(eosio::from_json_error::expected_base64_string));
+        return;
+    }
     eosio::check( !(s.size() & 1), eosio::convert_json_error(eosio::from_json_error::expected_hex_string) );
     eosio::varuint32_to_bin(s.size() / 2, state.writer);
     // FIXME: Add a function to encode a hex string to a stream
@@ -359,14 +828,40 @@ void json_to_bin(bytes*, State& state, bool, const abi_type*, bool start) {
         eosio::convert_json_error(eosio::from_json_error::expected_hex_string));
 }
 
+// A bytes value may be an object, which is serialized as the type that state.bytes_type gives it. The object's steps
+// run on the state's stack like any others; finish_nested_bytes inserts the size once they are done.
+inline void json_to_bin(bytes*, jvalue_to_bin_state& state, bool allow_extensions, const abi_type* type, bool start) {
+    auto* obj = std::get_if<jobject>(&state.received_value->value);
+    const abi_type* t = nullptr;
+    if (obj && state.bytes_type && !state.stack.empty()) {
+        // Only a field of an object names an action; a bytes[] element has an array as its parent
+        if (auto* parent = std::get_if<jobject>(&state.stack.back().value->value))
+            t = state.bytes_type(*parent);
+    }
+    if (!t)
+        return json_to_bin<jvalue_to_bin_state>((bytes*)nullptr, state, allow_extensions, type, start);
+    state.nested.push_back({state.writer.data.size(), state.stack.size(), state.skipped_extension});
+    state.skipped_extension = false;
+    t->ser->json_to_bin(state, true, t, true);
+    state.finish_nested_bytes();
+}
+
 inline void bin_to_json(bytes*, bin_to_json_state& state, bool, const abi_type*, bool start) {
     uint64_t size;
     varuint64_from_bin(size, state.bin);
     const char* data;
     state.bin.read_reuse_storage(data, size);
+    if (state.encoding != bytes_encoding::hex)
+        return eosio::to_json_base64(data, size, state.encoding == bytes_encoding::base64url, state.writer);
     return to_json_hex(data, size, state.writer);
 }
 
+inline void skip_bin(bytes*, skip_bin_state& state, bool, const abi_type*, bool start) {
+    uint64_t size;
+    varuint64_from_bin(size, state.bin);
+    state.bin.skip(size);
+}
+
 using eosio::float128;
 using eosio::checksum160;
 using eosio::checksum256;
@@ -448,6 +943,29 @@ void to_json(const int128& obj, S& stream) {
 
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// fixed-size types
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+constexpr size_t fixed_bin_size(T*) {
+    if constexpr (eosio::has_bitwise_serialization<T>())
+        return sizeof(T);
+    else
+        return 0;
+}
+
+template <size_t Size, typename Word>
+constexpr size_t fixed_bin_size(eosio::fixed_bytes<Size, Word>*) { return Size; }
+
+constexpr size_t fixed_bin_size(name*) { return 8; }
+constexpr size_t fixed_bin_size(time_point*) { return 8; }
+constexpr size_t fixed_bin_size(time_point_sec*) { return 4; }
+constexpr size_t fixed_bin_size(block_timestamp*) { return 4; }
+constexpr size_t fixed_bin_size(symbol_code*) { return 8; }
+constexpr size_t fixed_bin_size(symbol*) { return 8; }
+constexpr size_t fixed_bin_size(asset*) { return 16; }
+
 ///////////////////////////////////////////////////////////////////////////////
 // abi types
 ///////////////////////////////////////////////////////////////////////////////
@@ -474,8 +992,6 @@ ABIEOS_NODISCARD inline bool receive_event(struct json_to_jvalue_state& state, e
         return set_error(state, "extra data");
     if (state.stack.size() > max_stack_size)
         return set_error(state, "recursion limit reached");
-    if (trace_json_to_jvalue_event)
-        printf("(event %d)\n", (int)event);
     auto& v = *state.stack.back().value;
     if (start) {
         state.stack.pop_back();
@@ -505,8 +1021,7 @@ ABIEOS_NODISCARD inline bool receive_event(struct json_to_jvalue_state& state, e
     return true;
 }
 
-template<typename F>
-inline void json_to_jvalue(jvalue& value, std::string_view json, F&& f) {
+inline void json_to_jvalue(jvalue& value, std::string_view json) {
     std::string mutable_json{json};
     mutable_json.push_back(0);
     mutable_json.push_back(0);
@@ -525,13 +1040,9 @@ ABIEOS_NODISCARD inline bool json_to_jobject(jvalue& value, json_to_jvalue_state
     if (start) {
         if (event != event_type::received_start_object)
             return set_error(state, "expected object");
-        if (trace_json_to_jvalue)
-            printf("%*s{\n", int(state.stack.size() * 4), "");
         state.stack.push_back({&value});
         return true;
     } else if (event == event_type::received_end_object) {
-        if (trace_json_to_jvalue)
-            printf("%*s}\n", int((state.stack.size() - 1) * 4), "");
         state.stack.pop_back();
         return true;
     }
@@ -540,8 +1051,6 @@ ABIEOS_NODISCARD inline bool json_to_jobject(jvalue& value, json_to_jvalue_state
         stack_entry.key = std::move(state.received_data.key);
         return true;
     } else {
-        if (trace_json_to_jvalue)
-            printf("%*sfield %s (event %d)\n", int(state.stack.size() * 4), "", stack_entry.key.c_str(), (int)event);
         auto& x = std::get<jobject>(value.value)[stack_entry.key] = {};
         state.stack.push_back({&x});
         return receive_event(state, event, true);
@@ -552,19 +1061,13 @@ ABIEOS_NODISCARD inline bool json_to_jarray(jvalue& value, json_to_jvalue_state&
     if (start) {
         if (event != event_type::received_start_array)
             return set_error(state, "expected array");
-        if (trace_json_to_jvalue)
-            printf("%*s[\n", int(state.stack.size() * 4), "");
         state.stack.push_back({&value});
         return true;
     } else if (event == event_type::received_end_array) {
-        if (trace_json_to_jvalue)
-            printf("%*s]\n", int((state.stack.size() - 1) * 4), "");
         state.stack.pop_back();
         return true;
     }
     auto& v = std::get<jarray>(value.value);
-    if (trace_json_to_jvalue)
-        printf("%*sitem %d (event %d)\n", int(state.stack.size() * 4), "", int(v.size()), (int)event);
     v.emplace_back();
     state.stack.push_back({&v.back()});
     return receive_event(state, event, true);
@@ -580,19 +1083,169 @@ ABIEOS_NODISCARD inline bool json_to_jarray(jvalue& value, json_to_jvalue_state&
 
 using abi = eosio::abi;
 
+///////////////////////////////////////////////////////////////////////////////
+// hooks
+///////////////////////////////////////////////////////////////////////////////
+
+// The json_to_bin and bin_to_json drivers report their progress to a hooks object: begin with the top-level type,
+// step before every step of the state machine with the type on top of the stack, the stack depth and the number of
+// bytes read (bin_to_json) or written (json_to_bin) so far, and end once the value is complete.
+struct no_hooks {
+    void begin(const abi_type*) {}
+    void step(const abi_type*, size_t depth, size_t pos) {}
+    void end(size_t pos) {}
+};
+
+// Prints every step to stdout
+struct trace_hooks {
+    void begin(const abi_type* type) { printf("%s\n", type->name.c_str()); }
+    void step(const abi_type* type, size_t depth, size_t pos) {
+        printf("%*s%s @%d\n", int(depth * 4), "", type->name.c_str(), int(pos));
+    }
+    void end(size_t pos) { printf("end @%d\n", int(pos)); }
+};
+
+inline uint64_t read_cycle_counter() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+struct type_profile {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    uint64_t cycles = 0; // nanoseconds on targets without a cycle counter
+};
+
+// Collects a type_profile for every struct, array and variant. The bytes and cycles spent between two steps are
+// charged to the type on top of the stack, so a type's totals include its builtin fields and elements but not its
+// nested structs, arrays and variants.
+struct profile_hooks {
+    std::map<const abi_type*, type_profile> profile;
+    const abi_type* current = nullptr;
+    size_t depth = 0;
+    size_t pos = 0;
+    uint64_t cycles = 0;
+
+    void begin(const abi_type* type) {
+        ++profile[type].count;
+        current = type;
+        depth = 1;
+        pos = 0;
+        cycles = read_cycle_counter();
+    }
+    void step(const abi_type* type, size_t depth, size_t pos) {
+        if (current)
+            charge(pos);
+        else
+            resume(depth, pos);
+        if (depth > this->depth)
+            ++profile[type].count;
+        current = type;
+        this->depth = depth;
+    }
+    void end(size_t pos) {
+        if (current)
+            charge(pos);
+    }
+
+    // Starts from the middle of a conversion begun in an earlier call, as incremental_json_to_bin continues
+    void resume(size_t depth, size_t pos) {
+        this->depth = depth;
+        this->pos = pos;
+        cycles = read_cycle_counter();
+    }
+
+    void charge(size_t new_pos) {
+        auto now = read_cycle_counter();
+        auto& p = profile[current];
+        p.bytes += new_pos - pos;
+        p.cycles += now - cycles;
+        pos = new_pos;
+        cycles = now;
+    }
+};
+
+// Limits on the work of a single conversion; 0 means no limit
+struct budget {
+    uint64_t max_steps = 0;
+    uint64_t max_output_size = 0;
+    std::chrono::nanoseconds time_limit{0};
+
+    bool unlimited() const { return !max_steps && !max_output_size && !time_limit.count(); }
+};
+
+// What a conversion has used of its budget. Conversions made of several calls or values share one.
+struct budget_usage {
+    uint64_t steps = 0;
+    std::chrono::steady_clock::time_point deadline{}; // set by the first begin
+};
+
+// budget_hooks reads the clock once every this many steps
+inline constexpr uint64_t budget_clock_interval = 256;
+
+// Passes everything on to hooks, and throws once a conversion takes more steps, produces more output or runs longer
+// than limits allow. output_size(pos) gives the bytes of output so far. Output is checked on every step and at the
+// end, so a single string or bytes value may go past the limit before the conversion stops. begin may be called once
+// per value, e.g. per row; the time limit runs from the first.
+template <typename Hooks, typename OutputSize>
+struct budget_hooks {
+    const budget& limits;
+    Hooks& hooks;
+    OutputSize output_size;
+    budget_usage& usage;
+
+    void begin(const abi_type* type) {
+        if (limits.time_limit.count() && usage.deadline == std::chrono::steady_clock::time_point{})
+            usage.deadline = std::chrono::steady_clock::now() + limits.time_limit;
+        hooks.begin(type);
+    }
+    void step(const abi_type* type, size_t depth, size_t pos) {
+        ++usage.steps;
+        eosio::check(!limits.max_steps || usage.steps <= limits.max_steps,
+                     eosio::convert_abi_error(eosio::abi_error::step_limit_exceeded));
+        check_output(pos);
+        if (limits.time_limit.count() && usage.steps % budget_clock_interval == 0)
+            eosio::check(std::chrono::steady_clock::now() <= usage.deadline,
+                         eosio::convert_abi_error(eosio::abi_error::time_limit_exceeded));
+        hooks.step(type, depth, pos);
+    }
+    void end(size_t pos) {
+        check_output(pos);
+        hooks.end(pos);
+    }
+
+    void check_output(size_t pos) {
+        eosio::check(!limits.max_output_size || output_size(pos) <= limits.max_output_size,
+                     eosio::convert_abi_error(eosio::abi_error::output_limit_exceeded));
+    }
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // json_to_bin (jvalue)
 ///////////////////////////////////////////////////////////////////////////////
 
-template<typename F>
-inline void json_to_bin(std::vector<char>& bin, const abi_type* type, const jvalue& value, F&& f) {
+// bytes_type is as in jvalue_to_bin_state
+template <typename Hooks = no_hooks>
+inline void json_to_bin(std::vector<char>& bin, const abi_type* type, const jvalue& value, Hooks&& hooks = {},
+                        bytes_encoding encoding = bytes_encoding::hex,
+                        std::function<const abi_type*(const jobject& parent)> bytes_type = {}) {
+    size_t start = bin.size();
     jvalue_to_bin_state state{{bin}, &value};
+    state.encoding = encoding;
+    state.bytes_type = std::move(bytes_type);
+    hooks.begin(type);
     type->ser->json_to_bin(state, true, type, true);
     while (!state.stack.empty()) {
-        f();
         auto& entry = state.stack.back();
+        hooks.step(entry.type, state.stack.size(), bin.size() - start);
         entry.type->ser->json_to_bin(state, entry.allow_extensions, entry.type, false);
+        state.finish_nested_bytes();
     }
+    hooks.end(bin.size() - start);
 }
 
 template<typename State>
@@ -618,26 +1271,18 @@ inline void json_to_bin(pseudo_object*, jvalue_to_bin_state& state, bool allow_e
     if (start) {
        eosio::check(!(!state.received_value || !std::holds_alternative<jobject>(state.received_value->value)),
             eosio::convert_json_error(eosio::from_json_error::expected_start_object));
-        if (trace_jvalue_to_bin)
-            printf("%*s{ %d fields, allow_ex=%d\n", int(state.stack.size() * 4), "", int(type->as_struct()->fields.size()),
-                   allow_extensions);
         state.stack.push_back({type, allow_extensions, state.received_value, -1});
     }
     auto& stack_entry = state.stack.back();
     ++stack_entry.position;
     const std::vector<eosio::abi_field>& fields = stack_entry.type->as_struct()->fields;
     if (stack_entry.position == (int)fields.size()) {
-        if (trace_jvalue_to_bin)
-            printf("%*s}\n", int((state.stack.size() - 1) * 4), "");
         state.stack.pop_back();
         return;
     }
     auto& field = fields[stack_entry.position];
     auto& obj = std::get<jobject>(stack_entry.value->value);
     auto it = obj.find(field.name);
-    if (trace_jvalue_to_bin)
-        printf("%*sfield %d/%d: %s\n", int(state.stack.size() * 4), "", int(stack_entry.position),
-               int(fields.size()), std::string{field.name}.c_str());
     if (it == obj.end()) {
         if (field.type->extension_of() && allow_extensions) {
             state.skipped_extension = true;
@@ -658,9 +1303,6 @@ inline void json_to_bin(pseudo_array*, jvalue_to_bin_state& state, bool, const a
     if (start) {
        eosio::check(!(!state.received_value || !std::holds_alternative<jarray>(state.received_value->value)),
             eosio::convert_json_error(eosio::from_json_error::expected_start_array));
-        if (trace_jvalue_to_bin)
-            printf("%*s[ %d elements\n", int(state.stack.size() * 4), "",
-                   int(std::get<jarray>(state.received_value->value).size()));
         eosio::varuint32_to_bin(std::get<jarray>(state.received_value->value).size(), state.writer);
         state.stack.push_back({type, false, state.received_value, -1});
     }
@@ -668,14 +1310,10 @@ inline void json_to_bin(pseudo_array*, jvalue_to_bin_state& state, bool, const a
     auto& arr = std::get<jarray>(stack_entry.value->value);
     ++stack_entry.position;
     if (stack_entry.position == (int)arr.size()) {
-        if (trace_jvalue_to_bin)
-            printf("%*s]\n", int((state.stack.size() - 1) * 4), "");
         state.stack.pop_back();
         return;
     }
     state.received_value = &arr[stack_entry.position];
-    if (trace_jvalue_to_bin)
-        printf("%*sitem\n", int(state.stack.size() * 4), "");
     const abi_type * t = type->array_of();
     return t->ser->json_to_bin(state, false, t, true);
 }
@@ -690,9 +1328,6 @@ inline void json_to_bin(pseudo_variant*, jvalue_to_bin_state& state, bool allow_
             eosio::convert_json_error(eosio::from_json_error::expected_variant));
         eosio::check(std::holds_alternative<std::string>(arr[0].value),
             eosio::convert_json_error(eosio::from_json_error::expected_variant));
-        auto& typeName = std::get<std::string>(arr[0].value);
-        if (trace_jvalue_to_bin)
-            printf("%*s[ variant %s\n", int(state.stack.size() * 4), "", typeName.c_str());
         state.stack.push_back({type, allow_extensions, state.received_value, 0});
         return;
     }
@@ -709,8 +1344,6 @@ inline void json_to_bin(pseudo_variant*, jvalue_to_bin_state& state, bool allow_
         state.received_value = &arr[++stack_entry.position];
         return it->type->ser->json_to_bin(state, allow_extensions, it->type, true);
     } else {
-        if (trace_jvalue_to_bin)
-            printf("%*s]\n", int((state.stack.size() - 1) * 4), "");
         state.stack.pop_back();
     }
 }
@@ -727,8 +1360,6 @@ template <typename State>
 inline void json_to_bin(std::string*, State& state, bool, const abi_type*,
                                        bool start) {
     auto s = state.get_string();
-    if (trace_jvalue_to_bin)
-        printf("%*sstring: %.*s\n", int(state.stack.size() * 4), "", (int)s.size(), s.data());
     return to_bin(s, state.writer);
 }
 
@@ -736,44 +1367,195 @@ inline void json_to_bin(std::string*, State& state, bool, const abi_type*,
 // json_to_bin
 ///////////////////////////////////////////////////////////////////////////////
 
-template<typename F>
-inline void json_to_bin(std::vector<char>& bin, const abi_type* type, std::string_view json, F&& f) {
-    std::string mutable_json{json};
-    mutable_json.push_back(0);
-    mutable_json.push_back(0);
-    mutable_json.push_back(0);
-    std::vector<char> out_buf;
-    eosio::vector_stream out(out_buf);
-    json_to_bin_state state(mutable_json.data(), out);
+// Converts json to binary in scratch.bin, without the sizes listed in the returned state's size_insertions
+template <typename Hooks = no_hooks>
+inline json_to_bin_state& run_json_to_bin(scratch_buffers& scratch, const abi_type* type, std::string_view json,
+                                          Hooks&& hooks = {}, bytes_encoding encoding = bytes_encoding::hex) {
+    auto& state = scratch.start_json_to_bin(json);
+    state.encoding = encoding;
+    auto& out_buf = scratch.bin;
 
+    hooks.begin(type);
     type->ser->json_to_bin(state, true, type, true);
     while(!state.stack.empty()) {
-        f();
         auto entry = state.stack.back();
         auto* type = entry.type;
+        hooks.step(type, state.stack.size(), out_buf.size());
         eosio::check(state.stack.size() <= max_stack_size,
             eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
         type->ser->json_to_bin(state, entry.allow_extensions, type, false);
     }
+    hooks.end(out_buf.size());
     eosio::check(state.complete(),
         eosio::convert_json_error(eosio::from_json_error::expected_end));
+    return state;
+}
 
+// Calls write(begin, end) on each piece of the result of run_json_to_bin, in order, with the sizes inserted
+template <typename F>
+inline void write_json_to_bin_result(const std::vector<char>& out_buf, const json_to_bin_state& state, F&& write) {
     size_t pos = 0;
     for (auto& insertion : state.size_insertions) {
-        bin.insert(bin.end(), out_buf.begin() + pos, out_buf.begin() + insertion.position);
-        eosio::push_varuint32(bin, insertion.size);
+        write(out_buf.data() + pos, out_buf.data() + insertion.position);
+        char size[5];
+        char* end = size;
+        uint32_t val = insertion.size;
+        do {
+            uint8_t b = val & 0x7f;
+            val >>= 7;
+            b |= ((val > 0) << 7);
+            *end++ = b;
+        } while (val);
+        write(size, end);
         pos = insertion.position;
     }
-    bin.insert(bin.end(), out_buf.begin() + pos, out_buf.end());
+    write(out_buf.data() + pos, out_buf.data() + out_buf.size());
+}
+
+template <typename Hooks = no_hooks>
+inline void json_to_bin(scratch_buffers& scratch, std::vector<char>& bin, const abi_type* type, std::string_view json,
+                        Hooks&& hooks = {}, bytes_encoding encoding = bytes_encoding::hex) {
+    auto& state = run_json_to_bin(scratch, type, json, hooks, encoding);
+    bin.reserve(bin.size() + scratch.bin.size() + 5 * state.size_insertions.size());
+    write_json_to_bin_result(scratch.bin, state, [&](const char* begin, const char* end) { bin.insert(bin.end(), begin, end); });
+}
+
+// Appends the hex form of the binary to dest, without building the binary first
+template <typename Hooks = no_hooks>
+inline void json_to_hex(scratch_buffers& scratch, std::string& dest, const abi_type* type, std::string_view json,
+                        Hooks&& hooks = {}, bytes_encoding encoding = bytes_encoding::hex) {
+    auto& state = run_json_to_bin(scratch, type, json, hooks, encoding);
+    dest.reserve(dest.size() + 2 * (scratch.bin.size() + 5 * state.size_insertions.size()));
+    write_json_to_bin_result(scratch.bin, state, [&](const char* begin, const char* end) { append_hex(dest, begin, end); });
+}
+
+template <typename Hooks = no_hooks>
+inline void json_to_bin(std::vector<char>& bin, const abi_type* type, std::string_view json, Hooks&& hooks = {}) {
+    scratch_buffers scratch;
+    json_to_bin(scratch, bin, type, json, hooks);
 }
 
+// Converts json to binary from successive chunks of input, parsing each chunk as it arrives. Only the input which
+// hasn't been parsed yet is kept. The binary can't be assembled before the end, since array sizes come before their
+// elements.
+class incremental_json_to_bin {
+  public:
+    explicit incremental_json_to_bin(const abi_type* type, bytes_encoding encoding = bytes_encoding::hex)
+        : type{type} {
+        state.encoding = encoding;
+    }
+    incremental_json_to_bin(const incremental_json_to_bin&) = delete;
+    incremental_json_to_bin& operator=(const incremental_json_to_bin&) = delete;
+
+    // hooks are called as in json_to_bin; begin comes with the first step and end with the last, which may be in
+    // different calls
+    template <typename Hooks = no_hooks>
+    void append(std::string_view chunk, Hooks&& hooks = {}) {
+        size_t consumed = state.token_peeked() ? 0 : parse_start + state.tell();
+        auto* old_data = input.data();
+        size_t parse_pos = parse_start + state.tell();
+        input.resize(input.size() - 3);
+        input.erase(input.begin(), input.begin() + consumed);
+        input.insert(input.end(), chunk.begin(), chunk.end());
+        input.insert(input.end(), 3, 0);
+        input_offset += consumed;
+        parse_start = parse_pos - consumed;
+        state.move_input(input.data() + parse_start, input.data() - old_data - std::ptrdiff_t(consumed));
+        scan(input.size() - 3 - chunk.size());
+        run(false, hooks);
+    }
+
+    template <typename Hooks = no_hooks>
+    void finish(std::vector<char>& bin, Hooks&& hooks = {}) {
+        run(true, hooks);
+        eosio::check(state.complete(), eosio::convert_json_error(eosio::from_json_error::expected_end));
+        bin.reserve(bin.size() + out_buf.size() + 5 * state.size_insertions.size());
+        write_json_to_bin_result(out_buf, state,
+                                 [&](const char* begin, const char* end) { bin.insert(bin.end(), begin, end); });
+    }
+
+  private:
+    // More than the tokens any step reads, so a step never reaches the end of the input received so far
+    static constexpr size_t lookahead = 4;
+
+    const abi_type* type;
+    std::vector<char> input = std::vector<char>(3, 0); // unparsed input, then 3 nuls
+    size_t input_offset = 0;                          // of input[0] in the whole json
+    size_t parse_start = 0;                           // in input, where the parser was last moved
+    std::deque<size_t> token_ends{};                  // in the whole json, past the end of each complete token
+    bool scanning_string = false;
+    bool scanning_escape = false;
+    bool scanning_scalar = false;
+    bool started = false;
+    std::vector<char> out_buf{};
+    eosio::vector_stream writer{out_buf};
+    json_to_bin_state state{input.data(), writer};
+
+    // Finds the ends of the tokens in input, from pos on. This doesn't validate; the parser does that.
+    void scan(size_t pos) {
+        for (size_t end = input.size() - 3; pos < end; ++pos) {
+            char c = input[pos];
+            if (scanning_string) {
+                if (scanning_escape)
+                    scanning_escape = false;
+                else if (c == '\\')
+                    scanning_escape = true;
+                else if (c == '"') {
+                    scanning_string = false;
+                    token_ends.push_back(input_offset + pos + 1);
+                }
+                continue;
+            }
+            bool delimiter = c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ':' || c == '"' ||
+                             c == '[' || c == ']' || c == '{' || c == '}';
+            if (scanning_scalar) {
+                if (!delimiter)
+                    continue;
+                scanning_scalar = false;
+                token_ends.push_back(input_offset + pos);
+            }
+            if (c == '"')
+                scanning_string = true;
+            else if (c == '[' || c == ']' || c == '{' || c == '}')
+                token_ends.push_back(input_offset + pos + 1);
+            else if (!delimiter)
+                scanning_scalar = true;
+        }
+    }
+
+    // Runs steps while enough input is available, or all of it once finished
+    template <typename Hooks>
+    void run(bool finished, Hooks& hooks) {
+        auto pos = input_offset + parse_start + state.tell();
+        while (!token_ends.empty() && token_ends.front() <= pos)
+            token_ends.pop_front();
+        while (finished || token_ends.size() >= lookahead) {
+            if (!started) {
+                started = true;
+                hooks.begin(type);
+                type->ser->json_to_bin(state, true, type, true);
+            } else if (!state.stack.empty()) {
+                auto* type = state.stack.back().type;
+                hooks.step(type, state.stack.size(), out_buf.size());
+                eosio::check(state.stack.size() <= max_stack_size,
+                    eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+                type->ser->json_to_bin(state, state.stack.back().allow_extensions, type, false);
+            } else {
+                break;
+            }
+            if (state.stack.empty())
+                hooks.end(out_buf.size());
+            pos = input_offset + parse_start + state.tell();
+            while (!token_ends.empty() && token_ends.front() <= pos)
+                token_ends.pop_front();
+        }
+    }
+};
+
 inline void json_to_bin(pseudo_object*, json_to_bin_state& state, bool allow_extensions,
                                        const abi_type* type, bool start) {
     if (start) {
         state.get_start_object();
-        if (trace_json_to_bin)
-            printf("%*s{ %d fields, allow_ex=%d\n", int(state.stack.size() * 4), "", int(type->as_struct()->fields.size()),
-                   allow_extensions);
         state.stack.push_back({type, allow_extensions});
     }
     auto& stack_entry = state.stack.back();
@@ -788,8 +1570,6 @@ inline void json_to_bin(pseudo_object*, json_to_bin_state& state, bool allow_ext
             ++stack_entry.position;
             state.skipped_extension = true;
         }
-        if (trace_json_to_bin)
-            printf("%*s}\n", int((state.stack.size() - 1) * 4), "");
         state.stack.pop_back();
         return;
     }
@@ -804,9 +1584,6 @@ inline void json_to_bin(pseudo_object*, json_to_bin_state& state, bool allow_ext
         }
     } else {
         auto& field = fields[stack_entry.position];
-        if (trace_json_to_bin)
-            printf("%*sfield %d/%d: %s\n", int(state.stack.size() * 4), "", int(stack_entry.position),
-                   int(fields.size()), std::string{field.name}.c_str());
         field.type->ser->json_to_bin(state, allow_extensions && &field == &fields.back(), field.type,
                                             true);
     }
@@ -816,8 +1593,6 @@ inline void json_to_bin(pseudo_array*, json_to_bin_state& state, bool, const abi
                                        bool start) {
     if (start) {
         state.get_start_array();
-        if (trace_json_to_bin)
-            printf("%*s[\n", int(state.stack.size() * 4), "");
         state.stack.push_back({type, false});
         state.stack.back().size_insertion_index = state.size_insertions.size();
         // FIXME: add Stream::tellp or similar.
@@ -826,15 +1601,11 @@ inline void json_to_bin(pseudo_array*, json_to_bin_state& state, bool, const abi
     }
     auto& stack_entry = state.stack.back();
     if (state.get_end_array_pred()) {
-        if (trace_json_to_bin)
-            printf("%*s]\n", int((state.stack.size() - 1) * 4), "");
         state.size_insertions[stack_entry.size_insertion_index].size = stack_entry.position + 1;
         state.stack.pop_back();
         return;
     }
     ++stack_entry.position;
-    if (trace_json_to_bin)
-        printf("%*sitem\n", int(state.stack.size() * 4), "");
     const abi_type* t = type->array_of();
     t->ser->json_to_bin(state, false, t, true);
 }
@@ -843,8 +1614,6 @@ inline void json_to_bin(pseudo_variant*, json_to_bin_state& state, bool allow_ex
                                        const abi_type* type, bool start) {
     if (start) {
         state.get_start_array();
-        if (trace_json_to_bin)
-            printf("%*s[ variant\n", int(state.stack.size() * 4), "");
         state.stack.push_back({type, allow_extensions});
         return;
     }
@@ -853,16 +1622,12 @@ inline void json_to_bin(pseudo_variant*, json_to_bin_state& state, bool allow_ex
     if (state.get_end_array_pred()) {
        eosio::check(stack_entry.position == 2,
             eosio::convert_json_error(eosio::from_json_error::expected_variant));
-        if (trace_json_to_bin)
-            printf("%*s]\n", int((state.stack.size() - 1) * 4), "");
         state.stack.pop_back();
         return;
     }
     const std::vector<eosio::abi_field>& fields = *stack_entry.type->as_variant();
     if (stack_entry.position == 0) {
         auto typeName = state.get_string();
-        if (trace_json_to_bin)
-            printf("%*stype: %.*s\n", int(state.stack.size() * 4), "", (int)typeName.size(), typeName.data());
         auto it = std::find_if(fields.begin(), fields.end(),
                                [&](auto& field) { return field.name == typeName; });
         eosio::check(it != fields.end(),
@@ -881,21 +1646,86 @@ inline void json_to_bin(pseudo_variant*, json_to_bin_state& state, bool allow_ex
 // bin_to_json
 ///////////////////////////////////////////////////////////////////////////////
 
-template<typename F>
-inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, std::string& dest, F&& f) {
-    // FIXME: Write directly to the string instead of creating an additional buffer
-    std::vector<char> buffer;
-    eosio::vector_stream writer{buffer};
-    bin_to_json_state state{bin, writer};
-    type->ser->bin_to_json(state, true, type, true);
+template <typename Hooks = no_hooks>
+inline void run_bin_to_json(bin_to_json_state& state, bool allow_extensions, const abi_type* type,
+                            Hooks&& hooks = {}) {
+    const char* start = state.bin.pos;
+    hooks.begin(type);
+    type->ser->bin_to_json(state, allow_extensions, type, true);
     while (!state.stack.empty()) {
-        f();
         auto& entry = state.stack.back();
+        hooks.step(entry.type, state.stack.size(), state.bin.pos - start);
         entry.type->ser->bin_to_json(state, entry.allow_extensions, entry.type, false);
         eosio::check(state.stack.size() <= max_stack_size,
             eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
     }
-    dest = std::string_view(writer.data.data(), writer.data.size());
+    hooks.end(state.bin.pos - start);
+}
+
+template <typename Hooks = no_hooks>
+inline void bin_to_json(scratch_buffers& scratch, eosio::input_stream& bin, const abi_type* type, std::string& dest,
+                        Hooks&& hooks = {}, bytes_encoding encoding = bytes_encoding::hex) {
+    scratch.bin.clear();
+    bin_to_json_state state{bin, scratch.bin_stream};
+    state.encoding = encoding;
+    state.stack.swap(scratch.bin_to_json_stack);
+    state.stack.clear();
+    run_bin_to_json(state, true, type, hooks);
+    state.stack.swap(scratch.bin_to_json_stack);
+    dest = std::string_view(scratch.bin.data(), scratch.bin.size());
+}
+
+template <typename Hooks = no_hooks>
+inline void bin_to_json(eosio::input_stream& bin, const abi_type* type, std::string& dest, Hooks&& hooks = {},
+                        bytes_encoding encoding = bytes_encoding::hex) {
+    scratch_buffers scratch;
+    bin_to_json(scratch, bin, type, dest, hooks, encoding);
+}
+
+// Passes the output of bin_to_json to write(data, size) in chunks of chunk_size bytes (the last may be shorter) as it
+// is produced. Output is buffered in scratch.bin, which holds at most chunk_size bytes plus the largest single value.
+template <typename F, typename Hooks>
+struct chunked_output_hooks {
+    std::vector<char>& buf;
+    size_t chunk_size;
+    F& write;
+    Hooks& hooks;
+
+    // Writes chunks while at least min_size bytes remain
+    void flush(size_t min_size) {
+        size_t pos = 0;
+        while (buf.size() - pos >= min_size) {
+            auto size = std::min(chunk_size, buf.size() - pos);
+            write(buf.data() + pos, size);
+            pos += size;
+        }
+        buf.erase(buf.begin(), buf.begin() + pos);
+    }
+
+    void begin(const abi_type* type) { hooks.begin(type); }
+    void step(const abi_type* type, size_t depth, size_t pos) {
+        flush(chunk_size);
+        hooks.step(type, depth, pos);
+    }
+    void end(size_t pos) {
+        hooks.end(pos);
+        flush(1);
+    }
+};
+
+template <typename F, typename Hooks = no_hooks>
+inline void bin_to_json(scratch_buffers& scratch, eosio::input_stream& bin, const abi_type* type, size_t chunk_size,
+                        F&& write, Hooks&& hooks = {}, bytes_encoding encoding = bytes_encoding::hex) {
+    scratch.bin.clear();
+    if (scratch.bin.capacity() < chunk_size)
+        scratch.bin.reserve(chunk_size);
+    bin_to_json_state state{bin, scratch.bin_stream};
+    state.encoding = encoding;
+    state.stack.swap(scratch.bin_to_json_stack);
+    state.stack.clear();
+    chunked_output_hooks<F, Hooks> output{scratch.bin, std::max(chunk_size, size_t(1)), write, hooks};
+    run_bin_to_json(state, true, type, output);
+    state.stack.swap(scratch.bin_to_json_stack);
 }
 
 inline void bin_to_json(bin_to_json_state& state, bool allow_extensions, const abi_type* type, bool start) {
@@ -919,8 +1749,6 @@ inline void bin_to_json(pseudo_extension*, bin_to_json_state& state, bool allow_
 inline void bin_to_json(pseudo_object*, bin_to_json_state& state, bool allow_extensions,
                                        const abi_type* type, bool start) {
     if (start) {
-        if (trace_bin_to_json)
-            printf("%*s{ %d fields\n", int(state.stack.size() * 4), "", int(type->as_struct()->fields.size()));
         state.stack.push_back({type, allow_extensions});
         state.writer.write('{');
         return;
@@ -929,9 +1757,6 @@ inline void bin_to_json(pseudo_object*, bin_to_json_state& state, bool allow_ext
     const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
     if (++stack_entry.position < (ptrdiff_t)fields.size()) {
         auto& field = fields[stack_entry.position];
-        if (trace_bin_to_json)
-            printf("%*sfield %d/%d: %s\n", int(state.stack.size() * 4), "", int(stack_entry.position),
-                   int(fields.size()), std::string{field.name}.c_str());
         if (state.bin.pos == state.bin.end && field.type->extension_of() && allow_extensions) {
             state.skipped_extension = true;
             return;
@@ -941,8 +1766,6 @@ inline void bin_to_json(pseudo_object*, bin_to_json_state& state, bool allow_ext
         state.writer.write(':');
         bin_to_json(state, allow_extensions && &field == &fields.back(), field.type, true);
     } else {
-        if (trace_bin_to_json)
-            printf("%*s}\n", int((state.stack.size() - 1) * 4), "");
         state.stack.pop_back();
         state.writer.write('}');
     }
@@ -953,20 +1776,13 @@ inline void bin_to_json(pseudo_array*, bin_to_json_state& state, bool, const abi
     if (start) {
         state.stack.push_back({type, false});
         varuint32_from_bin(state.stack.back().array_size, state.bin);
-        if (trace_bin_to_json)
-            printf("%*s[ %d items\n", int(state.stack.size() * 4), "", int(state.stack.back().array_size));
         return state.writer.write('[');
     }
     auto& stack_entry = state.stack.back();
     if (++stack_entry.position < (ptrdiff_t)stack_entry.array_size) {
-        if (trace_bin_to_json)
-            printf("%*sitem %d/%d %p %s\n", int(state.stack.size() * 4), "", int(stack_entry.position),
-                   int(stack_entry.array_size), type->array_of()->ser, type->array_of()->name.c_str());
         if (stack_entry.position != 0) { state.writer.write(','); }
         return bin_to_json(state, false, type->array_of(), true);
     } else {
-        if (trace_bin_to_json)
-            printf("%*s]\n", int((state.stack.size()) * 4), "");
         state.stack.pop_back();
         return state.writer.write(']');
     }
@@ -976,8 +1792,6 @@ inline void bin_to_json(pseudo_variant*, bin_to_json_state& state, bool allow_ex
                                          const abi_type* type, bool start) {
     if (start) {
         state.stack.push_back({type, allow_extensions});
-        if (trace_bin_to_json)
-            printf("%*s[ variant\n", int(state.stack.size() * 4), "");
         return state.writer.write('[');
     }
     auto& stack_entry = state.stack.back();
@@ -992,8 +1806,6 @@ inline void bin_to_json(pseudo_variant*, bin_to_json_state& state, bool allow_ex
         // FIXME: allow_extensions should be stack_entry.allow_extensions, so why are we combining them?
         bin_to_json(state, allow_extensions && stack_entry.allow_extensions, f.type, true);
     } else {
-        if (trace_bin_to_json)
-            printf("%*s]\n", int((state.stack.size()) * 4), "");
         state.stack.pop_back();
         state.writer.write(']');
     }
@@ -1007,4 +1819,1103 @@ auto bin_to_json(T* t, bin_to_json_state& state, bool, const abi_type*, bool sta
     return to_json(v, state.writer);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// bin_to_document
+///////////////////////////////////////////////////////////////////////////////
+
+// Converts binary to cbor or msgpack, with the same structure as bin_to_json gives: structs are maps, arrays are
+// arrays, variants are [type name, value] and absent optionals are null. Integers up to 64 bits and floats are numbers;
+// bytes, checksums and float128 are byte strings; assets are {"amount","precision","symbol"} maps; other types are
+// strings, as in json. hooks are called as in bin_to_json.
+template <typename Hooks = no_hooks>
+inline void bin_to_document(eosio::input_stream& bin, const abi_type* type, document_format format,
+                            std::vector<char>& dest, Hooks&& hooks = {}) {
+    const char* start = bin.pos;
+    bin_to_document_state state{bin, format, dest};
+    hooks.begin(type);
+    type->ser->bin_to_document(state, true, type, true);
+    while (!state.stack.empty()) {
+        auto& entry = state.stack.back();
+        hooks.step(entry.type, state.stack.size(), bin.pos - start);
+        entry.type->ser->bin_to_document(state, entry.allow_extensions, entry.type, false);
+        eosio::check(state.stack.size() <= max_stack_size,
+            eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    }
+    hooks.end(bin.pos - start);
+}
+
+inline void bin_to_document(bin_to_document_state& state, bool allow_extensions, const abi_type* type, bool start) {
+    type->ser->bin_to_document(state, allow_extensions, type, start);
+}
+
+inline void bin_to_document(pseudo_optional*, bin_to_document_state& state, bool allow_extensions,
+                            const abi_type* type, bool) {
+    bool present;
+    from_bin(present, state.bin);
+    if (present)
+        return bin_to_document(state, allow_extensions, type->optional_of(), true);
+    state.writer.write_null();
+}
+
+inline void bin_to_document(pseudo_extension*, bin_to_document_state& state, bool allow_extensions,
+                            const abi_type* type, bool) {
+    bin_to_document(state, allow_extensions, type->extension_of(), true);
+}
+
+inline void bin_to_document(pseudo_object*, bin_to_document_state& state, bool allow_extensions,
+                            const abi_type* type, bool start) {
+    const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
+    if (start) {
+        state.stack.push_back({type, allow_extensions});
+        state.stack.back().header = state.writer.begin_map(fields.size());
+        return;
+    }
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position < (ptrdiff_t)fields.size()) {
+        auto& field = fields[stack_entry.position];
+        if (state.bin.pos == state.bin.end && field.type->extension_of() && allow_extensions)
+            return;
+        ++stack_entry.size;
+        state.writer.write_string(field.name);
+        bin_to_document(state, allow_extensions && &field == &fields.back(), field.type, true);
+    } else {
+        if (stack_entry.size != fields.size())
+            state.writer.set_map_size(stack_entry.header, stack_entry.size);
+        state.stack.pop_back();
+    }
+}
+
+inline void bin_to_document(pseudo_array*, bin_to_document_state& state, bool, const abi_type* type,
+                            bool start) {
+    if (start) {
+        state.stack.push_back({type, false});
+        varuint32_from_bin(state.stack.back().size, state.bin);
+        return state.writer.begin_array(state.stack.back().size);
+    }
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position < (ptrdiff_t)stack_entry.size)
+        return bin_to_document(state, false, type->array_of(), true);
+    state.stack.pop_back();
+}
+
+inline void bin_to_document(pseudo_variant*, bin_to_document_state& state, bool allow_extensions,
+                            const abi_type* type, bool start) {
+    if (start) {
+        state.stack.push_back({type, allow_extensions});
+        return state.writer.begin_array(2);
+    }
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position == 0) {
+        uint32_t index;
+        varuint32_from_bin(index, state.bin);
+        const std::vector<eosio::abi_field>& fields = *stack_entry.type->as_variant();
+        eosio::check(index < fields.size(), eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+        auto& f = fields[index];
+        state.writer.write_string(f.name);
+        bin_to_document(state, allow_extensions && stack_entry.allow_extensions, f.type, true);
+    } else {
+        state.stack.pop_back();
+    }
+}
+
+// Writes the string which to_json gives v, without the quotes
+template <typename T>
+void write_json_string(const T& v, bin_to_document_state& state) {
+    state.text.clear();
+    eosio::vector_stream stream{state.text};
+    to_json(v, stream);
+    state.writer.write_string({state.text.data() + 1, state.text.size() - 2});
+}
+
+template <typename T>
+auto bin_to_document(T*, bin_to_document_state& state, bool, const abi_type*, bool)
+    -> std::enable_if_t<std::is_arithmetic_v<T> && sizeof(T) <= 8> {
+    T v;
+    from_bin(v, state.bin);
+    if constexpr (std::is_same_v<T, bool>)
+        state.writer.write_bool(v);
+    else if constexpr (std::is_same_v<T, float>)
+        state.writer.write_float(v);
+    else if constexpr (std::is_same_v<T, double>)
+        state.writer.write_double(v);
+    else if constexpr (std::is_signed_v<T>)
+        state.writer.write_int(v);
+    else
+        state.writer.write_uint(v);
+}
+
+inline void bin_to_document(varuint32*, bin_to_document_state& state, bool, const abi_type*, bool) {
+    uint32_t v;
+    varuint32_from_bin(v, state.bin);
+    state.writer.write_uint(v);
+}
+
+inline void bin_to_document(varint32*, bin_to_document_state& state, bool, const abi_type*, bool) {
+    int32_t v;
+    varint32_from_bin(v, state.bin);
+    state.writer.write_int(v);
+}
+
+inline void bin_to_document(std::string*, bin_to_document_state& state, bool, const abi_type*, bool) {
+    uint32_t size;
+    varuint32_from_bin(size, state.bin);
+    const char* data;
+    state.bin.read_reuse_storage(data, size);
+    state.writer.write_string({data, size});
+}
+
+inline void bin_to_document(bytes*, bin_to_document_state& state, bool, const abi_type*, bool) {
+    uint64_t size;
+    varuint64_from_bin(size, state.bin);
+    const char* data;
+    state.bin.read_reuse_storage(data, size);
+    state.writer.write_bytes(data, size);
+}
+
+template <typename T>
+auto bin_to_document(T*, bin_to_document_state& state, bool, const abi_type*, bool)
+    -> std::enable_if_t<std::is_same_v<T, checksum160> || std::is_same_v<T, checksum256> ||
+                        std::is_same_v<T, checksum512> || std::is_same_v<T, float128>> {
+    const char* data;
+    state.bin.read_reuse_storage(data, sizeof(T));
+    state.writer.write_bytes(data, sizeof(T));
+}
+
+inline void bin_to_document(asset*, bin_to_document_state& state, bool, const abi_type*, bool) {
+    asset v;
+    from_bin(v, state.bin);
+    state.writer.begin_map(3);
+    state.writer.write_string("amount");
+    state.writer.write_int(v.amount);
+    state.writer.write_string("precision");
+    state.writer.write_uint(v.symbol.precision());
+    state.writer.write_string("symbol");
+    write_json_string(v.symbol.code(), state);
+}
+
+template <typename T>
+auto bin_to_document(T*, bin_to_document_state& state, bool, const abi_type*, bool)
+    -> std::enable_if_t<std::is_same_v<T, name> || std::is_same_v<T, public_key> || std::is_same_v<T, private_key> ||
+                        std::is_same_v<T, signature> || std::is_same_v<T, time_point> ||
+                        std::is_same_v<T, time_point_sec> || std::is_same_v<T, block_timestamp> ||
+                        std::is_same_v<T, symbol> || std::is_same_v<T, symbol_code> ||
+                        std::is_same_v<T, int128> || std::is_same_v<T, uint128>> {
+    T v;
+    from_bin(v, state.bin);
+    write_json_string(v, state);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// skip_bin
+///////////////////////////////////////////////////////////////////////////////
+
+// Moves bin past one value of type without formatting it. hooks.step is called as in bin_to_json, with the stack
+// depth added to depth and the bytes read counted from start. begin and end are left to the caller, since skipping
+// is also a part of other conversions.
+template <typename Hooks>
+inline void skip_bin(eosio::input_stream& bin, const abi_type* type, bool allow_extensions, Hooks&& hooks,
+                     size_t depth, const char* start) {
+    skip_bin_state state{bin};
+    type->ser->skip_bin(state, allow_extensions, type, true);
+    while (!state.stack.empty()) {
+        auto& entry = state.stack.back();
+        hooks.step(entry.type, depth + state.stack.size(), bin.pos - start);
+        entry.type->ser->skip_bin(state, entry.allow_extensions, entry.type, false);
+        eosio::check(state.stack.size() <= max_stack_size,
+            eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    }
+}
+
+inline void skip_bin(eosio::input_stream& bin, const abi_type* type, bool allow_extensions) {
+    skip_bin(bin, type, allow_extensions, no_hooks{}, 0, bin.pos);
+}
+
+inline void skip_bin(pseudo_optional*, skip_bin_state& state, bool allow_extensions,
+                                       const abi_type* type, bool) {
+    bool present;
+    from_bin(present, state.bin);
+    if (present) {
+        auto* t = type->optional_of();
+        t->ser->skip_bin(state, allow_extensions, t, true);
+    }
+}
+
+inline void skip_bin(pseudo_extension*, skip_bin_state& state, bool allow_extensions,
+                                       const abi_type* type, bool) {
+    auto* t = type->extension_of();
+    t->ser->skip_bin(state, allow_extensions, t, true);
+}
+
+inline void skip_bin(pseudo_object*, skip_bin_state& state, bool allow_extensions,
+                                       const abi_type* type, bool start) {
+    if (start) {
+        state.stack.push_back({type, allow_extensions});
+        return;
+    }
+    auto& stack_entry = state.stack.back();
+    const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
+    if (++stack_entry.position < (ptrdiff_t)fields.size()) {
+        auto& field = fields[stack_entry.position];
+        if (state.bin.pos == state.bin.end && field.type->extension_of() && allow_extensions)
+            return;
+        field.type->ser->skip_bin(state, allow_extensions && &field == &fields.back(), field.type, true);
+    } else {
+        state.stack.pop_back();
+    }
+}
+
+inline void skip_bin(pseudo_array*, skip_bin_state& state, bool, const abi_type* type,
+                                         bool start) {
+    if (start) {
+        state.stack.push_back({type, false});
+        varuint32_from_bin(state.stack.back().array_size, state.bin);
+        return;
+    }
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position < (ptrdiff_t)stack_entry.array_size) {
+        auto* t = type->array_of();
+        t->ser->skip_bin(state, false, t, true);
+    } else {
+        state.stack.pop_back();
+    }
+}
+
+inline void skip_bin(pseudo_variant*, skip_bin_state& state, bool allow_extensions,
+                                         const abi_type* type, bool start) {
+    if (start) {
+        state.stack.push_back({type, allow_extensions});
+        return;
+    }
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position == 0) {
+        uint32_t index;
+        varuint32_from_bin(index, state.bin);
+        const std::vector<eosio::abi_field>& fields = *stack_entry.type->as_variant();
+        eosio::check(index < fields.size(), eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+        auto& f = fields[index];
+        f.type->ser->skip_bin(state, allow_extensions && stack_entry.allow_extensions, f.type, true);
+    } else {
+        state.stack.pop_back();
+    }
+}
+
+inline void skip_bin(std::string*, skip_bin_state& state, bool, const abi_type*, bool start) {
+    uint32_t size;
+    varuint32_from_bin(size, state.bin);
+    state.bin.skip(size);
+}
+
+template <typename T>
+void skip_bin(T*, skip_bin_state& state, bool, const abi_type*, bool start) {
+    if constexpr (eosio::has_bitwise_serialization<T>()) {
+        state.bin.skip(sizeof(T));
+    } else {
+        T v;
+        from_bin(v, state.bin);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// check_bin
+///////////////////////////////////////////////////////////////////////////////
+
+// Checks that bin starts with a value of type, and moves past it, without throwing. This checks what decoding in
+// bin_to_json checks (sizes, varuint encodings, variant indexes and nesting), so bad input can be rejected at the
+// cost of a scan instead of an exception.
+inline error_code check_bin(eosio::input_stream& bin, const abi_type* type, bool allow_extensions = true) {
+    check_bin_state state{bin};
+    if (!type->ser->check_bin(state, allow_extensions, type, true))
+        return state.error;
+    while (!state.stack.empty()) {
+        auto& entry = state.stack.back();
+        if (!entry.type->ser->check_bin(state, entry.allow_extensions, entry.type, false))
+            return state.error;
+        if (state.stack.size() > max_stack_size) {
+            state.error.abi = eosio::abi_error::recursion_limit_reached;
+            return state.error;
+        }
+    }
+    return {};
+}
+
+ABIEOS_NODISCARD inline bool check_bin(pseudo_optional*, check_bin_state& state, bool allow_extensions,
+                                       const abi_type* type, bool) {
+    if (state.bin.pos == state.bin.end)
+        return state.fail(eosio::stream_error::overrun);
+    if (!*state.bin.pos++)
+        return true;
+    auto* t = type->optional_of();
+    return t->ser->check_bin(state, allow_extensions, t, true);
+}
+
+ABIEOS_NODISCARD inline bool check_bin(pseudo_extension*, check_bin_state& state, bool allow_extensions,
+                                       const abi_type* type, bool) {
+    auto* t = type->extension_of();
+    return t->ser->check_bin(state, allow_extensions, t, true);
+}
+
+ABIEOS_NODISCARD inline bool check_bin(pseudo_object*, check_bin_state& state, bool allow_extensions,
+                                       const abi_type* type, bool start) {
+    if (start)
+        return state.push({type, allow_extensions});
+    auto& stack_entry = state.stack.back();
+    const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
+    if (++stack_entry.position < (ptrdiff_t)fields.size()) {
+        auto& field = fields[stack_entry.position];
+        if (state.bin.pos == state.bin.end && field.type->extension_of() && allow_extensions)
+            return true;
+        return field.type->ser->check_bin(state, allow_extensions && &field == &fields.back(), field.type, true);
+    }
+    state.stack.pop_back();
+    return true;
+}
+
+ABIEOS_NODISCARD inline bool check_bin(pseudo_array*, check_bin_state& state, bool, const abi_type* type,
+                                       bool start) {
+    if (start) {
+        uint32_t size;
+        if (!state.read_varuint32(size) || !state.push({type, false}))
+            return false;
+        state.stack.back().array_size = size;
+        return true;
+    }
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position < (ptrdiff_t)stack_entry.array_size) {
+        auto* t = type->array_of();
+        return t->ser->check_bin(state, false, t, true);
+    }
+    state.stack.pop_back();
+    return true;
+}
+
+ABIEOS_NODISCARD inline bool check_bin(pseudo_variant*, check_bin_state& state, bool allow_extensions,
+                                       const abi_type* type, bool start) {
+    if (start)
+        return state.push({type, allow_extensions});
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position == 0) {
+        uint32_t index;
+        if (!state.read_varuint32(index))
+            return false;
+        const std::vector<eosio::abi_field>& fields = *stack_entry.type->as_variant();
+        if (index >= fields.size())
+            return state.fail(eosio::stream_error::bad_variant_index);
+        auto& f = fields[index];
+        return f.type->ser->check_bin(state, allow_extensions && stack_entry.allow_extensions, f.type, true);
+    }
+    state.stack.pop_back();
+    return true;
+}
+
+ABIEOS_NODISCARD inline bool check_bin(std::string*, check_bin_state& state, bool, const abi_type*, bool) {
+    uint32_t size;
+    return state.read_varuint32(size) && state.skip(size);
+}
+
+ABIEOS_NODISCARD inline bool check_bin(bytes*, check_bin_state& state, bool, const abi_type*, bool) {
+    uint64_t size;
+    return state.read_varuint64(size) && state.skip(size);
+}
+
+ABIEOS_NODISCARD inline bool check_bin(varuint32*, check_bin_state& state, bool, const abi_type*, bool) {
+    uint32_t v;
+    return state.read_varuint32(v);
+}
+
+ABIEOS_NODISCARD inline bool check_bin(varint32*, check_bin_state& state, bool, const abi_type*, bool) {
+    uint32_t v;
+    return state.read_varuint32(v);
+}
+
+// K1 and R1 keys hold key_size bytes. WebAuthn ones (index 2) add webauthn_size bytes and then num_webauthn_sizes
+// length-prefixed fields.
+ABIEOS_NODISCARD inline bool check_key(check_bin_state& state, size_t key_size, bool allow_webauthn,
+                                       size_t webauthn_size, int num_webauthn_sizes) {
+    uint32_t index;
+    if (!state.read_varuint32(index))
+        return false;
+    if (index > 2 || (index == 2 && !allow_webauthn))
+        return state.fail(eosio::stream_error::bad_variant_index);
+    if (!state.skip(key_size))
+        return false;
+    if (index == 2) {
+        if (!state.skip(webauthn_size))
+            return false;
+        for (int i = 0; i < num_webauthn_sizes; ++i) {
+            uint32_t size;
+            if (!state.read_varuint32(size) || !state.skip(size))
+                return false;
+        }
+    }
+    return true;
+}
+
+// webauthn_public_key: key, user_presence (uint8), rpid (string)
+ABIEOS_NODISCARD inline bool check_bin(public_key*, check_bin_state& state, bool, const abi_type*, bool) {
+    return check_key(state, std::tuple_size_v<eosio::ecc_public_key>, true, 1, 1);
+}
+
+ABIEOS_NODISCARD inline bool check_bin(private_key*, check_bin_state& state, bool, const abi_type*, bool) {
+    return check_key(state, std::tuple_size_v<eosio::ecc_private_key>, false, 0, 0);
+}
+
+// webauthn_signature: compact_signature, auth_data (bytes), client_json (string)
+ABIEOS_NODISCARD inline bool check_bin(signature*, check_bin_state& state, bool, const abi_type*, bool) {
+    return check_key(state, std::tuple_size_v<eosio::ecc_signature>, true, 0, 2);
+}
+
+template <typename T>
+ABIEOS_NODISCARD bool check_bin(T*, check_bin_state& state, bool, const abi_type*, bool) {
+    static_assert(fixed_bin_size((T*)nullptr), "check_bin: type needs an overload");
+    return state.skip(fixed_bin_size((T*)nullptr));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// bin_to_key
+///////////////////////////////////////////////////////////////////////////////
+
+// Converts one value of type to the order-preserving encoding of eosio/to_key.hpp. The result is the
+// same as to_key on the equivalent C++ type. Binary extensions are encoded like optionals. hooks are called as in
+// bin_to_json.
+template <typename Hooks = no_hooks>
+inline void bin_to_key(eosio::input_stream& bin, const abi_type* type, std::vector<char>& key,
+                       bool allow_extensions = true, Hooks&& hooks = {}) {
+    const char* start = bin.pos;
+    eosio::vector_stream writer{key};
+    bin_to_key_state state{bin, writer};
+    hooks.begin(type);
+    type->ser->bin_to_key(state, allow_extensions, type, true);
+    while (!state.stack.empty()) {
+        auto& entry = state.stack.back();
+        hooks.step(entry.type, state.stack.size(), bin.pos - start);
+        entry.type->ser->bin_to_key(state, entry.allow_extensions, entry.type, false);
+        eosio::check(state.stack.size() <= max_stack_size,
+            eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    }
+    hooks.end(bin.pos - start);
+}
+
+// Within optionals and arrays, to_key escapes values of single-byte types instead of prefixing them
+inline bool has_single_byte_key(const abi_type* type) {
+    return type->name == "bool" || type->name == "int8" || type->name == "uint8";
+}
+
+// to_key_optional for a present value
+inline void bin_to_key_present(bin_to_key_state& state, const abi_type* type) {
+    if (has_single_byte_key(type)) {
+        type->ser->bin_to_key(state, false, type, true);
+        if (state.writer.data.back() == '\0')
+            state.writer.write('\1');
+    } else {
+        state.writer.write('\1');
+        type->ser->bin_to_key(state, false, type, true);
+    }
+}
+
+// to_key_optional for an absent value
+inline void bin_to_key_absent(bin_to_key_state& state, const abi_type* type) {
+    if (has_single_byte_key(type))
+        state.writer.write("\0", 2);
+    else
+        state.writer.write('\0');
+}
+
+inline void bin_to_key(pseudo_optional*, bin_to_key_state& state, bool allow_extensions,
+                                       const abi_type* type, bool) {
+    bool present;
+    from_bin(present, state.bin);
+    if (present)
+        bin_to_key_present(state, type->optional_of());
+    else
+        bin_to_key_absent(state, type->optional_of());
+}
+
+inline void bin_to_key(pseudo_extension*, bin_to_key_state& state, bool allow_extensions,
+                                       const abi_type* type, bool) {
+    bin_to_key_present(state, type->extension_of());
+}
+
+inline void bin_to_key(pseudo_object*, bin_to_key_state& state, bool allow_extensions,
+                                       const abi_type* type, bool start) {
+    if (start) {
+        state.stack.push_back({type, allow_extensions});
+        return;
+    }
+    auto& stack_entry = state.stack.back();
+    const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
+    if (++stack_entry.position < (ptrdiff_t)fields.size()) {
+        auto& field = fields[stack_entry.position];
+        if (state.bin.pos == state.bin.end && field.type->extension_of() && allow_extensions)
+            return bin_to_key_absent(state, field.type->extension_of());
+        field.type->ser->bin_to_key(state, allow_extensions && &field == &fields.back(), field.type, true);
+    } else {
+        state.stack.pop_back();
+    }
+}
+
+inline void bin_to_key(pseudo_array*, bin_to_key_state& state, bool, const abi_type* type,
+                                         bool start) {
+    if (start) {
+        state.stack.push_back({type, false});
+        varuint32_from_bin(state.stack.back().array_size, state.bin);
+        return;
+    }
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position < (ptrdiff_t)stack_entry.array_size) {
+        bin_to_key_present(state, type->array_of());
+    } else {
+        bin_to_key_absent(state, type->array_of());
+        state.stack.pop_back();
+    }
+}
+
+inline void bin_to_key(pseudo_variant*, bin_to_key_state& state, bool allow_extensions,
+                                         const abi_type* type, bool start) {
+    if (start) {
+        state.stack.push_back({type, allow_extensions});
+        return;
+    }
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position == 0) {
+        uint32_t index;
+        varuint32_from_bin(index, state.bin);
+        const std::vector<eosio::abi_field>& fields = *stack_entry.type->as_variant();
+        eosio::check(index < fields.size(), eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+        eosio::to_key_varuint32(index, state.writer);
+        auto& f = fields[index];
+        f.type->ser->bin_to_key(state, allow_extensions && stack_entry.allow_extensions, f.type, true);
+    } else {
+        state.stack.pop_back();
+    }
+}
+
+inline void bin_to_key(std::string*, bin_to_key_state& state, bool, const abi_type*, bool start) {
+    std::string_view s;
+    from_bin(s, state.bin);
+    to_key(s, state.writer);
+}
+
+inline void bin_to_key(varint32*, bin_to_key_state& state, bool, const abi_type*, bool start) {
+    eosio::check(false, eosio::convert_abi_error(eosio::abi_error::invalid_key_type));
+}
+
+template <typename T>
+void bin_to_key(T*, bin_to_key_state& state, bool, const abi_type*, bool start) {
+    using eosio::to_key;
+    T v;
+    from_bin(v, state.bin);
+    to_key(v, state.writer);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// random_bin
+///////////////////////////////////////////////////////////////////////////////
+
+// Appends a random valid value of type to bin. The same rng state, type and options always produce the same value.
+// Use bin_to_json to get the value in JSON form.
+inline void random_bin(std::mt19937_64& rng, const abi_type* type, std::vector<char>& bin,
+                       const random_bin_options& options = {}, bool allow_extensions = true) {
+    eosio::vector_stream writer{bin};
+    random_bin_state state{rng, writer, options};
+    type->ser->random_bin(state, allow_extensions, type, true);
+    while (!state.stack.empty()) {
+        auto& entry = state.stack.back();
+        entry.type->ser->random_bin(state, entry.allow_extensions, entry.type, false);
+        eosio::check(state.stack.size() <= max_stack_size,
+            eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+    }
+}
+
+inline void random_bin(pseudo_optional*, random_bin_state& state, bool allow_extensions,
+                                         const abi_type* type, bool) {
+    bool present = state.stack.size() < state.options.max_depth && state.chance(state.options.optional_chance);
+    to_bin(present, state.writer);
+    if (present) {
+        auto* t = type->optional_of();
+        t->ser->random_bin(state, allow_extensions, t, true);
+    }
+}
+
+inline void random_bin(pseudo_extension*, random_bin_state& state, bool allow_extensions,
+                                          const abi_type* type, bool) {
+    auto* t = type->extension_of();
+    t->ser->random_bin(state, allow_extensions, t, true);
+}
+
+inline void random_bin(pseudo_object*, random_bin_state& state, bool allow_extensions,
+                                       const abi_type* type, bool start) {
+    if (start) {
+        state.stack.push_back({type, allow_extensions});
+        return;
+    }
+    auto& stack_entry = state.stack.back();
+    const std::vector<eosio::abi_field>& fields = type->as_struct()->fields;
+    if (++stack_entry.position < (ptrdiff_t)fields.size()) {
+        auto& field = fields[stack_entry.position];
+        // Extensions may only be left out if every field after them is an extension too
+        if (field.type->extension_of() && allow_extensions && !state.chance(state.options.extension_chance) &&
+            std::all_of(fields.begin() + stack_entry.position, fields.end(),
+                        [](auto& f) { return f.type->extension_of(); })) {
+            state.stack.pop_back();
+            return;
+        }
+        field.type->ser->random_bin(state, allow_extensions && &field == &fields.back(), field.type, true);
+    } else {
+        state.stack.pop_back();
+    }
+}
+
+inline void random_bin(pseudo_array*, random_bin_state& state, bool, const abi_type* type, bool start) {
+    if (start) {
+        uint32_t size = 0;
+        if (state.stack.size() < state.options.max_depth)
+            size = state.below(uint64_t(state.options.max_array_size) + 1);
+        state.stack.push_back({type, false});
+        state.stack.back().array_size = size;
+        eosio::varuint32_to_bin(size, state.writer);
+        return;
+    }
+    auto& stack_entry = state.stack.back();
+    if (++stack_entry.position < (ptrdiff_t)stack_entry.array_size) {
+        auto* t = type->array_of();
+        t->ser->random_bin(state, false, t, true);
+    } else {
+        state.stack.pop_back();
+    }
+}
+
+inline void random_bin(pseudo_variant*, random_bin_state& state, bool allow_extensions,
+                                        const abi_type* type, bool) {
+    const std::vector<eosio::abi_field>& fields = *type->as_variant();
+    eosio::check(!fields.empty(), eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+    uint32_t index = state.below(fields.size());
+    eosio::varuint32_to_bin(index, state.writer);
+    fields[index].type->ser->random_bin(state, allow_extensions, fields[index].type, true);
+}
+
+inline void random_bytes(random_bin_state& state, size_t size) {
+    for (size_t i = 0; i < size; ++i)
+        state.writer.write(char(state.rng()));
+}
+
+inline void random_bin(std::string*, random_bin_state& state, bool, const abi_type*, bool) {
+    uint32_t size = state.below(uint64_t(state.options.max_string_size) + 1);
+    eosio::varuint32_to_bin(size, state.writer);
+    for (uint32_t i = 0; i < size; ++i)
+        state.writer.write(char(' ' + state.below(95)));
+}
+
+inline void random_bin(bytes*, random_bin_state& state, bool, const abi_type*, bool) {
+    uint32_t size = state.below(uint64_t(state.options.max_string_size) + 1);
+    eosio::varuint32_to_bin(size, state.writer);
+    random_bytes(state, size);
+}
+
+// Mostly small values, so that every encoded length is exercised
+inline void random_bin(varuint32*, random_bin_state& state, bool, const abi_type*, bool) {
+    eosio::varuint32_to_bin(uint32_t(state.rng() >> (32 + state.below(32))), state.writer);
+}
+
+inline void random_bin(varint32*, random_bin_state& state, bool, const abi_type*, bool) {
+    to_bin(varint32{int32_t(int64_t(state.rng()) >> (32 + state.below(32)))}, state.writer);
+}
+
+// Whole milliseconds (the JSON form has no more) between 1970 and 2100
+inline void random_bin(time_point*, random_bin_state& state, bool, const abi_type*, bool) {
+    to_bin(time_point{eosio::microseconds(state.below(4102444800000ull) * 1000)}, state.writer);
+}
+
+inline uint64_t random_symbol_code(random_bin_state& state) {
+    uint64_t value = 0;
+    for (int i = 1 + state.below(7); i > 0; --i)
+        value = (value << 8) | ('A' + state.below(26));
+    return value;
+}
+
+inline void random_bin(symbol_code*, random_bin_state& state, bool, const abi_type*, bool) {
+    to_bin(random_symbol_code(state), state.writer);
+}
+
+inline void random_bin(symbol*, random_bin_state& state, bool, const abi_type*, bool) {
+    to_bin(random_symbol_code(state) << 8 | state.below(19), state.writer);
+}
+
+inline void random_bin(asset*, random_bin_state& state, bool, const abi_type* type, bool) {
+    to_bin(int64_t(state.below(2 * asset::max_amount + 1)) - asset::max_amount, state.writer);
+    random_bin((symbol*)nullptr, state, false, type, true);
+}
+
+template <typename Key>
+void random_key(random_bin_state& state) {
+    eosio::varuint32_to_bin(state.below(2), state.writer); // K1 or R1
+    random_bytes(state, std::tuple_size_v<Key>);
+}
+
+inline void random_bin(public_key*, random_bin_state& state, bool, const abi_type*, bool) {
+    random_key<eosio::ecc_public_key>(state);
+}
+
+inline void random_bin(private_key*, random_bin_state& state, bool, const abi_type*, bool) {
+    random_key<eosio::ecc_private_key>(state);
+}
+
+inline void random_bin(signature*, random_bin_state& state, bool, const abi_type*, bool) {
+    random_key<eosio::ecc_signature>(state);
+}
+
+template <typename T>
+void random_bin(T*, random_bin_state& state, bool, const abi_type*, bool) {
+    if constexpr (std::is_same_v<T, bool>) {
+        to_bin(bool(state.below(2)), state.writer);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        to_bin(T(int64_t(state.rng()) * 0x1.0p-40), state.writer);
+    } else {
+        static_assert(fixed_bin_size((T*)nullptr), "random_bin: type needs an overload");
+        random_bytes(state, fixed_bin_size((T*)nullptr));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// transcode_bin
+///////////////////////////////////////////////////////////////////////////////
+
+// How to convert a value of one type to a value of another, usually the same type in another version of an abi.
+// Struct fields and variant cases are matched by name.
+struct transcode_plan {
+    enum class kind : uint8_t {
+        copy,        // same binary form
+        optional,    // T? to U?
+        to_optional, // T to U?
+        array,       // T[] to U[]
+        struct_,
+        variant,
+    };
+
+    // One step of converting a struct
+    struct field_op {
+        const abi_type* from = nullptr;       // the old field's type; null to write an absent optional instead
+        const transcode_plan* plan = nullptr; // null to skip the old field, which was removed
+        bool last = false;                    // the old struct's last field
+    };
+
+    kind k = kind::copy;
+    const abi_type* from = nullptr;
+    const transcode_plan* inner = nullptr;     // optional, to_optional, array
+    std::vector<field_op> fields{};            // struct_
+    std::vector<const transcode_plan*> cases{}; // variant: by old index; null if the new type lacks the case
+    std::vector<uint32_t> case_indexes{};       // variant: new index of each old case
+};
+
+// Compiles and keeps transcode_plans. Plans refer to the types they were compiled for, which must outlive them.
+class transcoder {
+  public:
+    // Compiles the plan for converting from to to, or returns the one compiled before. Throws if a value of from
+    // can't always be converted: a builtin type changes, a new field is neither an optional nor a trailing binary
+    // extension, struct fields are reordered, or an optional or binary extension would have to become required.
+    const transcode_plan* get_plan(const abi_type* from, const abi_type* to) {
+        std::vector<std::pair<const abi_type*, const abi_type*>> added;
+        try {
+            return compile(from, to, added);
+        } catch (...) {
+            for (auto& key : added)
+                plans.erase(key);
+            throw;
+        }
+    }
+
+    // Converts one value; allow_extensions as in bin_to_json. hooks are called as in bin_to_json, with a step before
+    // each field, array element and variant case.
+    template <typename Hooks = no_hooks>
+    static void transcode(const transcode_plan* plan, eosio::input_stream& bin, std::vector<char>& out,
+                          bool allow_extensions = true, Hooks&& hooks = {}) {
+        const char* start = bin.pos;
+        hooks.begin(plan->from);
+        transcode(plan, bin, out, allow_extensions, hooks, 0, start);
+        hooks.end(bin.pos - start);
+    }
+
+  private:
+    std::map<std::pair<const abi_type*, const abi_type*>, transcode_plan> plans;
+
+    template <typename Hooks>
+    static void transcode(const transcode_plan* plan, eosio::input_stream& bin, std::vector<char>& out,
+                          bool allow_extensions, Hooks& hooks, size_t depth, const char* start) {
+        eosio::check(depth <= max_stack_size, eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+        switch (plan->k) {
+        case transcode_plan::kind::copy: {
+            auto begin = bin.pos;
+            if (auto size = plan->from->ser->fixed_bin_size())
+                bin.skip(size);
+            else
+                skip_bin(bin, plan->from, allow_extensions, hooks, depth, start);
+            out.insert(out.end(), begin, bin.pos);
+            return;
+        }
+        case transcode_plan::kind::optional: {
+            bool present;
+            from_bin(present, bin);
+            out.push_back(present);
+            if (present)
+                transcode(plan->inner, bin, out, allow_extensions, hooks, depth + 1, start);
+            return;
+        }
+        case transcode_plan::kind::to_optional:
+            out.push_back(1);
+            return transcode(plan->inner, bin, out, allow_extensions, hooks, depth + 1, start);
+        case transcode_plan::kind::array: {
+            uint32_t size;
+            varuint32_from_bin(size, bin);
+            eosio::push_varuint32(out, size);
+            for (uint32_t i = 0; i < size; ++i) {
+                hooks.step(plan->from, depth + 1, bin.pos - start);
+                transcode(plan->inner, bin, out, false, hooks, depth + 1, start);
+            }
+            return;
+        }
+        case transcode_plan::kind::struct_:
+            for (auto& op : plan->fields) {
+                hooks.step(plan->from, depth + 1, bin.pos - start);
+                if (!op.from) {
+                    out.push_back(0);
+                    continue;
+                }
+                // An absent binary extension: the rest of the old fields, and so of the new ones, are absent too
+                if (bin.pos == bin.end && op.from->extension_of() && allow_extensions)
+                    return;
+                if (op.plan)
+                    transcode(op.plan, bin, out, allow_extensions && op.last, hooks, depth + 1, start);
+                else
+                    skip_bin(bin, op.from, allow_extensions && op.last, hooks, depth + 1, start);
+            }
+            return;
+        case transcode_plan::kind::variant: {
+            uint32_t index;
+            varuint32_from_bin(index, bin);
+            eosio::check(index < plan->cases.size(), eosio::convert_stream_error(eosio::stream_error::bad_variant_index));
+            eosio::check(plan->cases[index], eosio::convert_abi_error(eosio::abi_error::missing_variant_case));
+            eosio::push_varuint32(out, plan->case_indexes[index]);
+            hooks.step(plan->from, depth + 1, bin.pos - start);
+            return transcode(plan->cases[index], bin, out, allow_extensions, hooks, depth + 1, start);
+        }
+        }
+    }
+
+    static const abi_type* strip_extension(const abi_type* type) {
+        auto* t = type->extension_of();
+        return t ? t : type;
+    }
+
+    const transcode_plan* compile(const abi_type* from, const abi_type* to,
+                                  std::vector<std::pair<const abi_type*, const abi_type*>>& added) {
+        from = strip_extension(from);
+        to = strip_extension(to);
+        auto [it, inserted] = plans.try_emplace({from, to});
+        auto& plan = it->second;
+        if (!inserted)
+            return &plan;
+        added.push_back(it->first);
+        plan.from = from;
+        if (from == to)
+            return &plan;
+        // Set the kind before compiling the parts, so recursive types don't see a copy
+        if (from->optional_of() && to->optional_of()) {
+            plan.k = transcode_plan::kind::optional;
+            plan.inner = compile(from->optional_of(), to->optional_of(), added);
+        } else if (to->optional_of()) {
+            plan.k = transcode_plan::kind::to_optional;
+            plan.inner = compile(from, to->optional_of(), added);
+        } else if (from->array_of() && to->array_of()) {
+            plan.k = transcode_plan::kind::array;
+            plan.inner = compile(from->array_of(), to->array_of(), added);
+        } else if (from->as_struct() && to->as_struct()) {
+            plan.k = transcode_plan::kind::struct_;
+            compile_struct(plan, from->as_struct()->fields, to->as_struct()->fields, added);
+        } else if (from->as_variant() && to->as_variant()) {
+            plan.k = transcode_plan::kind::variant;
+            auto& from_cases = *from->as_variant();
+            auto& to_cases = *to->as_variant();
+            bool same = from_cases.size() == to_cases.size();
+            for (auto& c : from_cases) {
+                auto match = std::find_if(to_cases.begin(), to_cases.end(), [&](auto& t) { return t.name == c.name; });
+                plan.cases.push_back(match == to_cases.end() ? nullptr : compile(c.type, match->type, added));
+                plan.case_indexes.push_back(match - to_cases.begin());
+                same = same && plan.cases.back() && plan.cases.back()->k == transcode_plan::kind::copy &&
+                       plan.case_indexes.back() == plan.cases.size() - 1;
+            }
+            if (same)
+                plan.k = transcode_plan::kind::copy;
+        } else {
+            eosio::check(false, eosio::convert_abi_error(eosio::abi_error::incompatible_types));
+        }
+        if (plan.inner && plan.inner->k == transcode_plan::kind::copy && plan.k != transcode_plan::kind::to_optional)
+            plan.k = transcode_plan::kind::copy;
+        return &plan;
+    }
+
+    void compile_struct(transcode_plan& plan, const std::vector<eosio::abi_field>& from,
+                        const std::vector<eosio::abi_field>& to,
+                        std::vector<std::pair<const abi_type*, const abi_type*>>& added) {
+        size_t next = 0; // in to
+        bool same = from.size() == to.size();
+        bool in_extensions = false; // past an old binary extension, which may be absent
+        auto add_absent = [&](size_t end) {
+            for (; next < end; ++next) {
+                eosio::check(strip_extension(to[next].type)->optional_of() && !in_extensions,
+                             eosio::convert_abi_error(eosio::abi_error::incompatible_types));
+                plan.fields.push_back({nullptr, nullptr, false});
+                same = false;
+            }
+        };
+        for (size_t i = 0; i < from.size(); ++i) {
+            auto& field = from[i];
+            auto match = std::find_if(to.begin() + next, to.end(), [&](auto& t) { return t.name == field.name; });
+            bool last = i + 1 == from.size();
+            if (match == to.end()) {
+                eosio::check(std::none_of(to.begin(), to.begin() + next, [&](auto& t) { return t.name == field.name; }),
+                             eosio::convert_abi_error(eosio::abi_error::incompatible_types));
+                plan.fields.push_back({field.type, nullptr, last});
+                same = false;
+                continue;
+            }
+            add_absent(match - to.begin());
+            in_extensions = in_extensions || field.type->extension_of();
+            eosio::check(!in_extensions || match->type->extension_of(),
+                         eosio::convert_abi_error(eosio::abi_error::incompatible_types));
+            auto* field_plan = compile(field.type, match->type, added);
+            plan.fields.push_back({field.type, field_plan, last});
+            same = same && field_plan->k == transcode_plan::kind::copy && match - to.begin() == ptrdiff_t(i);
+            ++next;
+        }
+        // Trailing new binary extensions are left out; other new fields must be optionals
+        size_t end = next;
+        while (end < to.size() && !to[end].type->extension_of())
+            ++end;
+        add_absent(end);
+        for (; next < to.size(); ++next)
+            eosio::check(to[next].type->extension_of(), eosio::convert_abi_error(eosio::abi_error::incompatible_types));
+        if (same)
+            plan.k = transcode_plan::kind::copy;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// bin_to_json_parallel
+///////////////////////////////////////////////////////////////////////////////
+
+// The limits which bin_to_json_parallel's workers check; none unless hooks is a budget_hooks
+template <typename Hooks>
+std::pair<budget, budget_usage> worker_budget(const Hooks&) {
+    return {};
+}
+
+template <typename Hooks, typename OutputSize>
+std::pair<budget, budget_usage> worker_budget(const budget_hooks<Hooks, OutputSize>& hooks) {
+    return {hooks.limits, hooks.usage};
+}
+
+// Formats an array on up to num_threads threads. A skip pass records where each element starts;
+// the elements are then split into ranges of about equal size, each range is formatted on its own
+// thread and the results are joined in order. Other types, and arrays too small to be worth
+// splitting, are formatted on the calling thread, in scratch. hooks see the skip pass, which takes
+// the same steps as formatting; if they are budget_hooks, each worker also checks the time limit
+// and the size of its own output.
+template <typename Hooks = no_hooks>
+inline void bin_to_json_parallel(scratch_buffers& scratch, eosio::input_stream& bin, const abi_type* type,
+                                 std::string& dest, unsigned num_threads, Hooks&& hooks = {},
+                                 bytes_encoding encoding = bytes_encoding::hex) {
+    const abi_type* element = type->array_of();
+    if (!element || num_threads < 2 || bin.remaining() < 2 * min_parallel_chunk_size)
+        return bin_to_json(scratch, bin, type, dest, hooks, encoding);
+    scratch.bin.clear(); // nothing is formatted in it below
+
+    const char* start = bin.pos;
+    hooks.begin(type);
+    uint32_t size;
+    varuint32_from_bin(size, bin);
+    std::vector<const char*> offsets;
+    offsets.reserve(std::min<size_t>(size, bin.remaining()) + 1);
+    for (uint32_t i = 0; i < size; ++i) {
+        offsets.push_back(bin.pos);
+        hooks.step(type, 1, bin.pos - start);
+        skip_bin(bin, element, false, hooks, 1, start);
+    }
+    offsets.push_back(bin.pos);
+    hooks.end(bin.pos - start);
+
+    size_t total = offsets.back() - offsets.front();
+    size_t num_chunks = std::min<size_t>({num_threads, total / min_parallel_chunk_size, size});
+    num_chunks = std::max<size_t>(num_chunks, 1);
+    std::vector<size_t> bounds{0};
+    for (size_t i = 1; i < num_chunks; ++i) {
+        auto target = offsets.front() + total * i / num_chunks;
+        bounds.push_back(std::lower_bound(offsets.begin() + bounds.back(), offsets.end() - 1, target) -
+                         offsets.begin());
+    }
+    bounds.push_back(size);
+
+    std::vector<std::vector<char>> outputs(num_chunks);
+    std::vector<std::exception_ptr> errors(num_chunks);
+    // The skip pass has counted the steps
+    auto [limits, usage] = worker_budget(hooks);
+    limits.max_steps = 0;
+    auto format_chunk = [&](size_t chunk, auto&& hooks) {
+        eosio::vector_stream writer{outputs[chunk]};
+        for (size_t i = bounds[chunk]; i < bounds[chunk + 1]; ++i) {
+            if (i)
+                writer.write(',');
+            eosio::input_stream elem{offsets[i], offsets[i + 1]};
+            bin_to_json_state state{elem, writer};
+            state.encoding = encoding;
+            run_bin_to_json(state, false, element, hooks);
+            eosio::check(elem.pos == elem.end, eosio::convert_stream_error(eosio::stream_error::underrun));
+        }
+    };
+    auto format = [&](size_t chunk) {
+        try {
+            if (limits.unlimited())
+                return format_chunk(chunk, no_hooks{});
+            no_hooks inner;
+            budget_usage worker_usage = usage;
+            auto output_size = [&](size_t) { return outputs[chunk].size(); };
+            format_chunk(chunk, budget_hooks<no_hooks, decltype(output_size)>{limits, inner, output_size, worker_usage});
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+    // If a thread can't be started, the chunks left over are formatted on this one
+    std::vector<std::thread> threads;
+    size_t started = 1;
+    try {
+        for (; started < num_chunks; ++started)
+            threads.emplace_back(format, started);
+    } catch (...) {
+    }
+    format(0);
+    for (size_t i = started; i < num_chunks; ++i)
+        format(i);
+    for (auto& t : threads)
+        t.join();
+    for (auto& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+
+    size_t result_size = 2;
+    for (auto& out : outputs)
+        result_size += out.size();
+    dest.clear();
+    dest.reserve(result_size);
+    dest.push_back('[');
+    for (auto& out : outputs)
+        dest.append(out.data(), out.size());
+    dest.push_back(']');
+}
+
+template <typename Hooks = no_hooks>
+inline void bin_to_json_parallel(eosio::input_stream& bin, const abi_type* type, std::string& dest,
+                                 unsigned num_threads, Hooks&& hooks = {},
+                                 bytes_encoding encoding = bytes_encoding::hex) {
+    scratch_buffers scratch;
+    bin_to_json_parallel(scratch, bin, type, dest, num_threads, hooks, encoding);
+}
+
 } // namespace abieos
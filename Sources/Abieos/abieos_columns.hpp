@@ -0,0 +1,226 @@
+// copyright defined in abieos/LICENSE.txt
+
+#pragma once
+
+#include "abieos.hpp"
+
+#include <algorithm>
+#include <climits>
+
+namespace abieos {
+
+///////////////////////////////////////////////////////////////////////////////
+// columnar export
+///////////////////////////////////////////////////////////////////////////////
+
+// How a column stores its values
+enum class column_kind {
+    fixed,     // binary form; width bytes per row
+    varuint32, // decoded to uint32_t
+    varint32,  // decoded to int32_t
+    bytes,     // contents of a string or bytes; offsets index data
+    raw,       // binary form of any other type (arrays, variants, recursive structs); offsets index data
+};
+
+// One leaf of a (possibly nested) struct. Rows where the leaf is absent, because an enclosing optional or
+// binary extension is absent, are null: they have a clear bit in validity and are zero-filled (fixed width)
+// or empty (offsets) in data.
+struct column {
+    std::string name; // field path, e.g. "balance.quantity"
+    const abi_type* type = nullptr;
+    column_kind kind = column_kind::raw;
+    uint32_t width = 0; // 0 for bytes and raw columns
+    bool allow_extensions = false;
+    bool nullable = false;
+    std::vector<char> data;
+    std::vector<uint32_t> offsets{0}; // bytes and raw columns: row i is data[offsets[i], offsets[i + 1])
+    std::vector<uint8_t> validity;    // nullable columns: bit i (LSB first) is set if row i has a value
+};
+
+// A row is decoded by running the steps in order. An absent optional or extension skips the num_steps steps
+// which follow it and appends nulls to the num_columns columns starting at column.
+struct column_step {
+    enum kind_type { leaf, optional, extension } kind = leaf;
+    uint32_t column = 0;
+    uint32_t num_columns = 0;
+    uint32_t num_steps = 0;
+};
+
+// Decodes rows of one type into a column per leaf field, in field order. A type which is not a struct gets
+// a single column named after the type.
+class column_set {
+  public:
+    std::vector<column> columns;
+    size_t num_rows = 0;
+
+    explicit column_set(const abi_type* row_type) : row_type{row_type} {
+        std::vector<const abi_type*> path;
+        plan(row_type, row_type->as_struct() ? "" : row_type->name, true, false, path);
+    }
+
+    // Decodes one row. If the row is invalid, the columns are left as they were and the error is rethrown. hooks get a
+    // begin and end for the row and a step for each leaf, and for each step of skipping a raw value.
+    template <typename Hooks = no_hooks>
+    void add_row(eosio::input_stream bin, Hooks&& hooks = {}) {
+        const char* start = bin.pos;
+        if (num_rows % 8 == 0)
+            for (auto& c : columns)
+                if (c.nullable)
+                    c.validity.push_back(0);
+        try {
+            hooks.begin(row_type);
+            for (size_t i = 0; i < steps.size();) {
+                auto& step = steps[i++];
+                bool present = true;
+                if (step.kind == column_step::leaf) {
+                    hooks.step(columns[step.column].type, 1, bin.pos - start);
+                    append(columns[step.column], bin, hooks, start);
+                    continue;
+                } else if (step.kind == column_step::optional) {
+                    from_bin(present, bin);
+                } else {
+                    present = bin.pos != bin.end;
+                }
+                if (!present) {
+                    for (uint32_t j = step.column; j < step.column + step.num_columns; ++j)
+                        append_null(columns[j]);
+                    i += step.num_steps;
+                }
+            }
+            if (bin.pos != bin.end)
+                throw std::runtime_error("Extra data");
+            hooks.end(bin.pos - start);
+        } catch (...) {
+            rollback();
+            throw;
+        }
+        ++num_rows;
+    }
+
+  private:
+    const abi_type* row_type;
+    std::vector<column_step> steps;
+
+    void plan(const abi_type* type, const std::string& name, bool allow_extensions, bool nullable,
+              std::vector<const abi_type*>& path) {
+        eosio::check(path.size() < max_stack_size, eosio::convert_abi_error(eosio::abi_error::recursion_limit_reached));
+        if (auto* inner = type->optional_of())
+            return plan_nullable(column_step::optional, inner, name, allow_extensions, path);
+        if (auto* inner = type->extension_of()) {
+            if (allow_extensions)
+                return plan_nullable(column_step::extension, inner, name, allow_extensions, path);
+            return plan(inner, name, allow_extensions, nullable, path);
+        }
+
+        auto* s = type->as_struct();
+        if (s && std::find(path.begin(), path.end(), type) == path.end()) {
+            path.push_back(type);
+            for (auto& field : s->fields) {
+                auto field_name = name.empty() ? std::string{field.name} : name + "." + std::string{field.name};
+                bool field_allow_extensions = allow_extensions && &field == &s->fields.back();
+                // Like bin_to_json, any extension field may be absent once the row is exhausted
+                if (auto* inner = field.type->extension_of(); inner && allow_extensions)
+                    plan_nullable(column_step::extension, inner, field_name, field_allow_extensions, path);
+                else
+                    plan(field.type, field_name, field_allow_extensions, nullable, path);
+            }
+            path.pop_back();
+            return;
+        }
+
+        column c;
+        c.name = name;
+        c.type = type;
+        c.allow_extensions = allow_extensions;
+        c.nullable = nullable;
+        if ((c.width = type->ser->fixed_bin_size())) {
+            c.kind = column_kind::fixed;
+            c.offsets.clear();
+        } else if (type->name == "varuint32" || type->name == "varint32") {
+            c.kind = type->name == "varuint32" ? column_kind::varuint32 : column_kind::varint32;
+            c.width = 4;
+            c.offsets.clear();
+        } else if (type->name == "string" || type->name == "bytes") {
+            c.kind = column_kind::bytes;
+        }
+        steps.push_back({column_step::leaf, uint32_t(columns.size())});
+        columns.push_back(std::move(c));
+    }
+
+    void plan_nullable(column_step::kind_type kind, const abi_type* inner, const std::string& name,
+                       bool allow_extensions, std::vector<const abi_type*>& path) {
+        auto first_column = columns.size();
+        auto first_step = steps.size();
+        steps.push_back({kind, uint32_t(first_column)});
+        plan(inner, name, allow_extensions, true, path);
+        steps[first_step].num_columns = columns.size() - first_column;
+        steps[first_step].num_steps = steps.size() - first_step - 1;
+    }
+
+    template <typename Hooks>
+    void append(column& c, eosio::input_stream& bin, Hooks& hooks, const char* start) {
+        if (c.nullable)
+            c.validity.back() |= 1 << (num_rows % 8);
+        switch (c.kind) {
+        case column_kind::fixed:
+            bin.check_available(c.width);
+            c.data.insert(c.data.end(), bin.pos, bin.pos + c.width);
+            bin.skip(c.width);
+            return;
+        case column_kind::varuint32: {
+            uint32_t v;
+            varuint32_from_bin(v, bin);
+            c.data.insert(c.data.end(), (const char*)&v, (const char*)&v + sizeof(v));
+            return;
+        }
+        case column_kind::varint32: {
+            int32_t v;
+            varint32_from_bin(v, bin);
+            c.data.insert(c.data.end(), (const char*)&v, (const char*)&v + sizeof(v));
+            return;
+        }
+        case column_kind::bytes: {
+            uint32_t size;
+            varuint32_from_bin(size, bin);
+            bin.check_available(size);
+            c.data.insert(c.data.end(), bin.pos, bin.pos + size);
+            bin.skip(size);
+            break;
+        }
+        case column_kind::raw: {
+            auto begin = bin.pos;
+            skip_bin(bin, c.type, c.allow_extensions, hooks, 1, start);
+            c.data.insert(c.data.end(), begin, bin.pos);
+            break;
+        }
+        }
+        if (c.data.size() > UINT32_MAX)
+            throw std::runtime_error("column \"" + c.name + "\" is larger than 4 GiB");
+        c.offsets.push_back(c.data.size());
+    }
+
+    void append_null(column& c) {
+        if (c.width)
+            c.data.resize(c.data.size() + c.width);
+        else
+            c.offsets.push_back(c.offsets.back());
+    }
+
+    void rollback() {
+        for (auto& c : columns) {
+            if (c.width) {
+                c.data.resize(num_rows * c.width);
+            } else {
+                c.offsets.resize(num_rows + 1);
+                c.data.resize(c.offsets.back());
+            }
+            if (c.nullable) {
+                c.validity.resize((num_rows + 7) / 8);
+                if (num_rows % 8)
+                    c.validity.back() &= (1 << (num_rows % 8)) - 1;
+            }
+        }
+    }
+};
+
+} // namespace abieos
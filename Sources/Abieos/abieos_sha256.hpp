@@ -0,0 +1,148 @@
+// copyright defined in abieos/LICENSE.txt
+
+/*
+ * SHA-256, as specified in FIPS 180-4:
+ * https://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.180-4.pdf
+ *
+ * The interface follows abieos_ripemd160.hpp: sha256_init, then sha256_update any number of times, then
+ * sha256_digest, which leaves the state unchanged.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace abieos_sha256 {
+
+inline constexpr auto sha256_digest_size = 32;
+
+typedef struct {
+    uint32_t h[8];   /* The current hash state */
+    uint64_t length; /* Total number of bytes added to the hash, including those in buf */
+    uint8_t buf[64]; /* Bytes which haven't been fed through the compression function yet */
+    uint8_t bufpos;  /* number of bytes currently in the buffer */
+} sha256_state;
+
+/* The first 32 bits of the fractional parts of the square roots of the first 8 primes */
+inline const uint32_t initial_h[8] = {0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au,
+                                      0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u};
+
+/* The first 32 bits of the fractional parts of the cube roots of the first 64 primes */
+inline const uint32_t K[64] = {
+    0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+    0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+    0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+    0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+    0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+    0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+    0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+    0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u,
+};
+
+/* cyclic right-shift the 32-bit word n right by s bits */
+inline uint32_t ror(uint32_t n, int s) { return (n >> s) | (n << (32 - s)); }
+
+inline uint32_t load_be32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+inline void store_be32(uint8_t* p, uint32_t v) {
+    p[0] = uint8_t(v >> 24);
+    p[1] = uint8_t(v >> 16);
+    p[2] = uint8_t(v >> 8);
+    p[3] = uint8_t(v);
+}
+
+inline void sha256_init(sha256_state* self) {
+    memcpy(self->h, initial_h, sizeof(initial_h));
+    self->length = 0;
+    self->bufpos = 0;
+}
+
+/* Feeds one 64-byte block through the compression function */
+inline void sha256_compress(uint32_t* h, const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i)
+        w[i] = load_be32(block + 4 * i);
+    for (int i = 16; i < 64; ++i) {
+        uint32_t s0 = ror(w[i - 15], 7) ^ ror(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ror(w[i - 2], 17) ^ ror(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+    for (int i = 0; i < 64; ++i) {
+        uint32_t s1 = ror(e, 6) ^ ror(e, 11) ^ ror(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = hh + s1 + ch + K[i] + w[i];
+        uint32_t s0 = ror(a, 2) ^ ror(a, 13) ^ ror(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+        hh = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += hh;
+}
+
+template <typename T>
+inline void sha256_update(sha256_state* self, T* data, size_t length) {
+    auto p = (const uint8_t*)data;
+    self->length += length;
+
+    /* Top up a partly filled buffer first */
+    if (self->bufpos) {
+        size_t room = 64 - size_t(self->bufpos);
+        size_t n = room < length ? room : length;
+        memcpy(self->buf + self->bufpos, p, n);
+        self->bufpos += n;
+        p += n;
+        length -= n;
+        if (self->bufpos < 64)
+            return;
+        sha256_compress(self->h, self->buf);
+        self->bufpos = 0;
+    }
+
+    /* Whole blocks are compressed straight from the input */
+    for (; length >= 64; p += 64, length -= 64)
+        sha256_compress(self->h, p);
+
+    memcpy(self->buf, p, length);
+    self->bufpos = length;
+}
+
+inline void sha256_digest(const sha256_state* self, unsigned char* out) {
+    uint32_t h[8];
+    uint8_t buf[128];
+    memcpy(h, self->h, sizeof(h));
+    memcpy(buf, self->buf, self->bufpos);
+
+    /* Append the padding and the length in bits; this takes a second block if the first has no room for it */
+    size_t size = self->bufpos < 56 ? 64 : 128;
+    memset(buf + self->bufpos, 0, size - self->bufpos);
+    buf[self->bufpos] = 0x80;
+    store_be32(buf + size - 8, uint32_t(self->length >> 29));
+    store_be32(buf + size - 4, uint32_t(self->length << 3));
+    for (size_t i = 0; i < size; i += 64)
+        sha256_compress(h, buf + i);
+
+    for (int i = 0; i < 8; ++i)
+        store_be32(out + 4 * i, h[i]);
+}
+
+} // namespace abieos_sha256
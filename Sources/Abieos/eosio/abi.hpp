@@ -2,7 +2,6 @@
 
 #include "name.hpp"
 #include "types.hpp"
-#include <functional>
 #include <map>
 #include <string>
 #include <variant>
@@ -20,7 +19,13 @@ enum class abi_error {
    redefined_type,
    base_not_a_struct,
    extension_typedef,
-   bad_abi
+   bad_abi,
+   invalid_key_type,
+   incompatible_types,
+   missing_variant_case,
+   step_limit_exceeded,
+   output_limit_exceeded,
+   time_limit_exceeded,
 };
 
 constexpr inline std::string_view convert_abi_error(eosio::abi_error e) {
@@ -34,6 +39,12 @@ constexpr inline std::string_view convert_abi_error(eosio::abi_error e) {
       case abi_error::base_not_a_struct: return "Base not a struct";
       case abi_error::extension_typedef: return "Extension typedef";
       case abi_error::bad_abi: return "Bad ABI";
+      case abi_error::invalid_key_type: return "Type can not be used in a key";
+      case abi_error::incompatible_types: return "Types are not compatible";
+      case abi_error::missing_variant_case: return "Variant case is missing from the new type";
+      case abi_error::step_limit_exceeded: return "Step limit exceeded";
+      case abi_error::output_limit_exceeded: return "Output size limit exceeded";
+      case abi_error::time_limit_exceeded: return "Time limit exceeded";
       default: return "internal failure";
    };
 }
@@ -174,18 +185,36 @@ struct abi_def {
 EOSIO_REFLECT(abi_def, version, types, structs, actions, tables, ricardian_clauses, error_messages, abi_extensions,
               variants, action_results, kv_tables);
 
+// The type definitions of a binary abi, as convert(input_stream, abi&) reads them: names point into the abi's bytes
+struct field_def_view {
+   std::string_view name{};
+   std::string_view type{};
+};
+
+struct struct_def_view {
+   std::string_view            name{};
+   std::string_view            base{};
+   std::vector<field_def_view> fields{};
+};
+
+struct variant_def_view {
+   std::string_view              name{};
+   std::vector<std::string_view> types{};
+};
+
 struct abi_type;
 
 struct abi_field {
-   std::string     name;
-   const abi_type* type;
+   std::string_view name; // points into the abi's names, or to static storage
+   const abi_type*  type;
 };
 
 struct abi_type {
    std::string name;
 
    struct builtin {};
-   using alias_def = std::string;
+   using alias_def      = std::string;
+   using alias_def_view = std::string_view;
    struct alias {
       abi_type* type;
    };
@@ -203,8 +232,8 @@ struct abi_type {
       std::vector<abi_field> fields;
    };
    using variant = std::vector<abi_field>;
-   std::variant<builtin, const alias_def*, const struct_def*, const variant_def*, alias, optional, extension, array,
-                struct_, variant>
+   std::variant<builtin, const alias_def*, const struct_def*, const variant_def*, const alias_def_view*,
+                const struct_def_view*, const variant_def_view*, alias, optional, extension, array, struct_, variant>
                          _data;
    const abi_serializer* ser = nullptr;
 
@@ -236,21 +265,32 @@ struct abi_type {
    const struct_* as_struct() const { return std::get_if<struct_>(&_data); }
    const variant* as_variant() const { return std::get_if<variant>(&_data); }
 
-   std::string bin_to_json(
-         input_stream& bin, std::function<void()> f = [] {}) const;
-   std::vector<char> json_to_bin(
-         std::string_view json, std::function<void()> f = [] {}) const;
-   std::vector<char> json_to_bin_reorderable(
-         std::string_view json, std::function<void()> f = [] {}) const;
+   std::string       bin_to_json(input_stream& bin) const;
+   std::vector<char> json_to_bin(std::string_view json) const;
+   std::vector<char> json_to_bin_reorderable(std::string_view json) const;
+};
+
+struct abi_memory_usage {
+   size_t types  = 0;
+   size_t fields = 0; // in structs and variants
+   size_t names  = 0; // bytes of names
+   size_t bytes  = 0; // includes an estimate of allocator overhead
 };
 
 struct abi {
-   std::map<eosio::name, std::string> action_types;
-   std::map<eosio::name, std::string> table_types;
-   std::map<eosio::name, std::string> kv_tables;
-   std::map<std::string, abi_type>    abi_types;
-   std::map<eosio::name, std::string> action_result_types;
-   const abi_type*                    get_type(const std::string& name);
+   std::map<eosio::name, std::string>           action_types;
+   std::map<eosio::name, std::string>           table_types;
+   std::map<eosio::name, std::string>           kv_tables;
+   std::map<std::string, abi_type, std::less<>> abi_types; // excludes the shared types; see find_builtin_type
+   std::map<eosio::name, std::string>           action_result_types;
+   std::vector<char>                            names; // field and variant case names, stored once each
+   const abi_type*                              get_type(const std::string& name);
+
+   // Copies the names of the fields and variant cases of abi_types into names, so they live as long as the abi
+   void intern_names();
+
+   // Estimated heap use of the abi's own types; shared types aren't counted
+   abi_memory_usage memory_usage() const;
 
    // Adds a type to the abi.  Has no effect if the type is already present.
    // If the type is a struct, all members will be added recursively.
@@ -260,8 +300,60 @@ struct abi {
    abi_type* add_type();
 };
 
+// A resolved abi in a flat form, which loads without json parsing or type resolution. Types refer to each other
+// by their index in types. Only builtin types keep their name's meaning: a snapshot depends on the builtin types
+// of the abieos version which wrote it.
+enum class abi_snapshot_kind : uint8_t { builtin, alias, optional, extension, array, struct_, variant };
+
+inline constexpr uint32_t abi_snapshot_magic   = 0x73696261; // "abis"
+inline constexpr uint32_t abi_snapshot_version = 1;
+inline constexpr uint32_t abi_snapshot_no_type = 0xffff'ffff;
+
+struct abi_snapshot_field {
+   std::string name{};
+   uint32_t    type{};
+};
+
+EOSIO_REFLECT(abi_snapshot_field, name, type);
+
+struct abi_snapshot_type {
+   std::string                     name{};
+   uint8_t                         kind{}; // abi_snapshot_kind
+   uint32_t                        type = abi_snapshot_no_type; // element or alias target; base of a struct
+   std::vector<abi_snapshot_field> fields{};
+};
+
+EOSIO_REFLECT(abi_snapshot_type, name, kind, type, fields);
+
+struct abi_snapshot_contract {
+   eosio::name                        account{};
+   std::map<eosio::name, std::string> action_types{};
+   std::map<eosio::name, std::string> table_types{};
+   std::map<eosio::name, std::string> kv_tables{};
+   std::map<eosio::name, std::string> action_result_types{};
+   std::vector<abi_snapshot_type>     types{};
+};
+
+EOSIO_REFLECT(abi_snapshot_contract, account, action_types, table_types, kv_tables, action_result_types, types);
+
+struct abi_snapshot {
+   uint32_t                           magic   = abi_snapshot_magic;
+   uint32_t                           version = abi_snapshot_version;
+   std::vector<abi_snapshot_contract> contracts{};
+};
+
+EOSIO_REFLECT(abi_snapshot, magic, version, contracts);
+
 void convert(const abi_def& def, abi&);
+// Converts a binary abi_def without decoding it into an abi_def first. Skips the parts which don't describe types.
+void convert(input_stream bin, abi&);
 void convert(const abi& def, abi_def&);
+void convert(const abi_snapshot_contract& snapshot, abi&);
+void convert(const abi& def, abi_snapshot_contract&);
+
+// Finds one of the types which all abis share: the builtin types, extended_asset, and the arrays, optionals and
+// extensions of them. These are created once and never modified. Returns null if name isn't one of them.
+abi_type* find_builtin_type(std::string_view name);
 
 extern const abi_serializer* const object_abi_serializer;
 extern const abi_serializer* const variant_abi_serializer;
@@ -286,8 +378,11 @@ auto add_type(abi& a, T*) -> std::enable_if_t<reflection::has_for_each_field_v<T
 template <typename T>
 auto add_type(abi& a, T* t) -> std::enable_if_t<!reflection::has_for_each_field_v<T>, abi_type*> {
    auto iter = a.abi_types.find(get_type_name(t));
-   check(iter != a.abi_types.end(), convert_abi_error(abi_error::unknown_type));
-   return &iter->second;
+   if (iter != a.abi_types.end())
+      return &iter->second;
+   auto builtin = find_builtin_type(get_type_name(t));
+   check(builtin, convert_abi_error(abi_error::unknown_type));
+   return builtin;
 }
 
 template <typename T>
@@ -296,6 +391,8 @@ abi_type* add_type(abi& a, std::vector<T>*) {
    check(!(element_type->optional_of() || element_type->array_of() || element_type->extension_of()),
          convert_abi_error(abi_error::invalid_nesting));
    std::string name      = get_type_name((std::vector<T>*)nullptr);
+   if (auto builtin = find_builtin_type(name))
+      return builtin;
    auto [iter, inserted] = a.abi_types.try_emplace(name, name, abi_type::array{ element_type }, array_abi_serializer);
    return &iter->second;
 }
@@ -321,6 +418,8 @@ abi_type* add_type(abi& a, std::optional<T>*) {
    check(!(element_type->optional_of() || element_type->array_of() || element_type->extension_of()),
          convert_abi_error(abi_error::invalid_nesting));
    std::string name = get_type_name((std::optional<T>*)nullptr);
+   if (auto builtin = find_builtin_type(name))
+      return builtin;
    auto [iter, inserted] =
          a.abi_types.try_emplace(name, name, abi_type::optional{ element_type }, optional_abi_serializer);
    return &iter->second;
@@ -331,6 +430,8 @@ abi_type* add_type(abi& a, might_not_exist<T>*) {
    auto element_type = a.add_type<T>();
    check(!element_type->extension_of(), convert_abi_error(abi_error::invalid_nesting));
    std::string name = element_type->name + "$";
+   if (auto builtin = find_builtin_type(name))
+      return builtin;
    auto [iter, inserted] =
          a.abi_types.try_emplace(name, name, abi_type::extension{ element_type }, extension_abi_serializer);
    return &iter->second;
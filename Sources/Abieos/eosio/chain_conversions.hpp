@@ -1,6 +1,8 @@
 #pragma once
 
 #include "stream.hpp"
+#include <algorithm>
+#include <cstring>
 #include <chrono>
 #include <stdint.h>
 #include <string>
@@ -213,19 +215,128 @@ constexpr inline uint64_t string_to_name_strict(std::string_view str) {
    __builtin_unreachable();
 }
 
+inline constexpr char decimal_digit_pairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+// Writes the decimal digits of v, two at a time, so that they end at end. Returns where they begin.
+inline char* write_decimal_backward(char* end, uint64_t v) {
+   while (v >= 100) {
+      auto pair = decimal_digit_pairs + 2 * (v % 100);
+      v /= 100;
+      *--end = pair[1];
+      *--end = pair[0];
+   }
+   if (v >= 10) {
+      auto pair = decimal_digit_pairs + 2 * v;
+      *--end = pair[1];
+      *--end = pair[0];
+   } else {
+      *--end = '0' + v;
+   }
+   return end;
+}
+
+inline constexpr size_t max_name_chars = 13;
+
+// Length of the text form of name, which ends at its last non-dot char: the one holding the lowest set bit
+inline size_t name_size(uint64_t name) {
+   if (!name)
+      return 0;
+   int low_bit = __builtin_ctzll(name);
+   return low_bit < 4 ? 13 : (63 - low_bit) / 5 + 1;
+}
+
+// SWAR helpers for name conversion. Each byte of a word holds one char, or one 5-bit digit, of a name; the first is in
+// the lowest byte, as in memory on the little-endian targets which the binary format already assumes.
+namespace detail {
+   inline constexpr uint64_t byte_ones  = 0x0101'0101'0101'0101;
+   inline constexpr uint64_t byte_highs = 0x8080'8080'8080'8080;
+
+   // Spreads the digits of name into bytes: 0-7 into lo, and 8-12 into the low 5 bytes of hi
+   inline void spread_name_digits(uint64_t name, uint64_t& lo, uint64_t& hi) {
+      auto split = [](uint64_t x) { // 2 lanes of 4 digits
+         x = ((x >> 10) & 0x0000'03ff'0000'03ff) | ((x & 0x0000'03ff'0000'03ff) << 16);
+         return ((x >> 5) & 0x001f'001f'001f'001f) | ((x & 0x001f'001f'001f'001f) << 8);
+      };
+      uint64_t v = name >> 24;
+      lo         = split(((v >> 20) & 0xfffff) | ((v & 0xfffff) << 32));
+      hi         = split((name >> 4) & 0xfffff) | (name & 0xf) << 32;
+   }
+
+   // Inverse of spread_name_digits
+   inline uint64_t pack_name_digits(uint64_t lo, uint64_t hi) {
+      auto join = [](uint64_t x) { // 8 bytes to 2 lanes of 4 digits
+         x = ((x & 0x00ff'00ff'00ff'00ff) << 5) | ((x >> 8) & 0x00ff'00ff'00ff'00ff);
+         return ((x & 0x0000'ffff'0000'ffff) << 10) | ((x >> 16) & 0x0000'ffff'0000'ffff);
+      };
+      lo = join(lo);
+      return (lo & 0xfffff) << 44 | (lo >> 32) << 24 | (join(hi & 0xffff'ffff) & 0xfffff) << 4 | ((hi >> 32) & 0xf);
+   }
+
+   // Maps digits to the chars ".12345abcdefghijklmnopqrstuvwxyz"
+   inline uint64_t name_digits_to_chars(uint64_t d) {
+      uint64_t at_least_1 = ((d + 0x7f * byte_ones) >> 7) & byte_ones;
+      uint64_t at_least_6 = ((d + 0x7a * byte_ones) >> 7) & byte_ones;
+      return d + '.' * byte_ones + 2 * at_least_1 + 0x2b * at_least_6;
+   }
+
+   // Maps chars to digits, as char_to_name_digit does: chars which can't be in a name become 0
+   inline uint64_t name_chars_to_digits(uint64_t c) {
+      uint64_t low7  = c & ~byte_highs;
+      uint64_t ascii = ~c & byte_highs;
+      uint64_t lower = (low7 + (0x80 - 'a') * byte_ones) & ~(low7 + (0x80 - 'z' - 1) * byte_ones) & ascii;
+      uint64_t digit = (low7 + (0x80 - '1') * byte_ones) & ~(low7 + (0x80 - '5' - 1) * byte_ones) & ascii;
+      uint64_t c80   = c | byte_highs; // subtracting from this can't borrow from the next byte
+      return ((((c80 - ('a' - 6) * byte_ones) & ((lower >> 7) * 0xff)) |
+               ((c80 - '0' * byte_ones) & ((digit >> 7) * 0xff))) &
+              ~byte_highs);
+   }
+} // namespace detail
+
+// Writes all max_name_chars chars of name to dest, trailing dots included. Returns name_size(name).
+inline size_t name_to_chars(char* dest, uint64_t name) {
+   uint64_t lo, hi;
+   detail::spread_name_digits(name, lo, hi);
+   lo = detail::name_digits_to_chars(lo);
+   hi = detail::name_digits_to_chars(hi);
+   memcpy(dest, &lo, 8);
+   memcpy(dest + 8, &hi, 5);
+   return name_size(name);
+}
+
 inline std::string name_to_string(uint64_t name) {
-   static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
-   std::string        str(13, '.');
-
-   uint64_t tmp = name;
-   for (uint32_t i = 0; i <= 12; ++i) {
-      char c      = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
-      str[12 - i] = c;
-      tmp >>= (i == 0 ? 4 : 5);
+   char buf[max_name_chars];
+   return { buf, name_to_chars(buf, name) };
+}
+
+// Converts names to text in fixed slots of max_name_chars bytes, each padded with '\0' after the name
+inline void names_to_slots(const uint64_t* names, size_t count, char* slots) {
+   for (size_t i = 0; i < count; ++i, slots += max_name_chars) {
+      uint64_t lo, hi;
+      size_t   size = name_size(names[i]);
+      detail::spread_name_digits(names[i], lo, hi);
+      lo = detail::name_digits_to_chars(lo) & (size >= 8 ? ~uint64_t(0) : (uint64_t(1) << (8 * size)) - 1);
+      hi = detail::name_digits_to_chars(hi) & (size > 8 ? (uint64_t(1) << (8 * (size - 8))) - 1 : 0);
+      memcpy(slots, &lo, 8);
+      memcpy(slots + 8, &hi, 5);
    }
+}
 
-   const auto last = str.find_last_not_of('.');
-   return str.substr(0, last + 1);
+// Converts names in slots, as names_to_slots writes them, back to names. A name ends at the first '\0' or at the end of
+// its slot. As with string_to_name, chars which can't be in a name count as dots.
+inline void slots_to_names(const char* slots, size_t count, uint64_t* names) {
+   using detail::byte_highs;
+   using detail::byte_ones;
+   for (size_t i = 0; i < count; ++i, slots += max_name_chars) {
+      uint64_t lo = 0, hi = 0;
+      memcpy(&lo, slots, 8);
+      memcpy(&hi, slots + 8, 5);
+      // The lowest flagged byte is the first '\0'; hi always has one, past the slot
+      uint64_t zero_lo = (lo - byte_ones) & ~lo & byte_highs;
+      uint64_t zero_hi = (hi - byte_ones) & ~hi & byte_highs;
+      lo &= zero_lo ? ((zero_lo & -zero_lo) >> 7) - 1 : ~uint64_t(0);
+      hi &= zero_lo ? 0 : ((zero_hi & -zero_hi) >> 7) - 1;
+      names[i] = detail::pack_name_digits(detail::name_chars_to_digits(lo), detail::name_chars_to_digits(hi));
+   }
 }
 
 inline std::string microseconds_to_str(uint64_t microseconds) {
@@ -263,6 +374,60 @@ inline std::string microseconds_to_str(uint64_t microseconds) {
    return result;
 }
 
+// Length of the text form of a time: YYYY-MM-DDTHH:MM:SS.mmm
+inline constexpr size_t time_point_chars = 23;
+
+inline char* write_2_digits(char* dest, uint32_t v) {
+   *dest++ = decimal_digit_pairs[2 * v];
+   *dest++ = decimal_digit_pairs[2 * v + 1];
+   return dest;
+}
+
+// Writes microseconds_to_str(microseconds) to dest, which must have room for time_point_chars, and returns the end.
+// Timestamps close together share their date and often their second, so each thread keeps the text of the last second
+// it formatted and only redoes the parts which changed.
+inline char* microseconds_to_chars(char* dest, uint64_t microseconds) {
+   constexpr uint64_t seconds_per_day = 86400;
+   constexpr uint64_t year_10000      = 2932897 * seconds_per_day * 1000000; // microseconds_to_str keeps 4 digits
+   if (microseconds >= year_10000) {
+      auto str = microseconds_to_str(microseconds);
+      return std::copy(str.begin(), str.end(), dest);
+   }
+   struct second_cache {
+      uint64_t day    = ~uint64_t(0);
+      uint64_t second = ~uint64_t(0);
+      char     text[19]; // YYYY-MM-DDTHH:MM:SS
+   };
+   thread_local second_cache cache;
+   uint64_t second = microseconds / 1000000;
+   if (second != cache.second) {
+      uint64_t day = second / seconds_per_day;
+      if (day != cache.day) {
+         auto ymd = year_month_day{ sys_days{ days{ int(day) } } };
+         auto pos = write_2_digits(cache.text, ymd.year() / 100);
+         pos      = write_2_digits(pos, ymd.year() % 100);
+         *pos++   = '-';
+         pos      = write_2_digits(pos, ymd.month());
+         *pos++   = '-';
+         pos      = write_2_digits(pos, ymd.day());
+         *pos++   = 'T';
+         cache.day = day;
+      }
+      uint32_t time = second % seconds_per_day;
+      auto     pos  = write_2_digits(cache.text + 11, time / 3600);
+      *pos++        = ':';
+      pos           = write_2_digits(pos, time / 60 % 60);
+      *pos++        = ':';
+      write_2_digits(pos, time % 60);
+      cache.second = second;
+   }
+   dest           = std::copy(cache.text, cache.text + sizeof(cache.text), dest);
+   uint32_t ms    = microseconds / 1000 % 1000;
+   *dest++        = '.';
+   *dest++        = '0' + ms / 100;
+   return write_2_digits(dest, ms % 100);
+}
+
 [[nodiscard]] inline bool string_to_utc_seconds(uint32_t& result, const char*& s, const char* end, bool eat_fractional,
                                                 bool require_end) {
    auto parse_uint = [&](uint32_t& result, int digits) {
@@ -276,28 +441,48 @@ inline std::string microseconds_to_str(uint64_t microseconds) {
       return true;
    };
    uint32_t y, m, d, h, min, sec;
-   if (!parse_uint(y, 4))
-      return false;
-   if (s == end || *s++ != '-')
-      return false;
-   if (!parse_uint(m, 2))
-      return false;
-   if (s == end || *s++ != '-')
-      return false;
-   if (!parse_uint(d, 2))
-      return false;
-   if (s == end || *s++ != 'T')
-      return false;
-   if (!parse_uint(h, 2))
-      return false;
-   if (s == end || *s++ != ':')
-      return false;
-   if (!parse_uint(min, 2))
-      return false;
-   if (s == end || *s++ != ':')
-      return false;
-   if (!parse_uint(sec, 2))
-      return false;
+   // Fast path for the fixed layout which every formatter writes
+   if (end - s >= 19 && s[4] == '-' && s[7] == '-' && s[10] == 'T' && s[13] == ':' && s[16] == ':') {
+      uint32_t bad   = 0;
+      auto     digit = [&](int i) {
+         uint32_t v = uint8_t(s[i] - '0');
+         bad |= v > 9;
+         return v;
+      };
+      auto two_digits = [&](int i) { return digit(i) * 10 + digit(i + 1); };
+      y   = two_digits(0) * 100 + two_digits(2);
+      m   = two_digits(5);
+      d   = two_digits(8);
+      h   = two_digits(11);
+      min = two_digits(14);
+      sec = two_digits(17);
+      if (bad)
+         return false;
+      s += 19;
+   } else {
+      if (!parse_uint(y, 4))
+         return false;
+      if (s == end || *s++ != '-')
+         return false;
+      if (!parse_uint(m, 2))
+         return false;
+      if (s == end || *s++ != '-')
+         return false;
+      if (!parse_uint(d, 2))
+         return false;
+      if (s == end || *s++ != 'T')
+         return false;
+      if (!parse_uint(h, 2))
+         return false;
+      if (s == end || *s++ != ':')
+         return false;
+      if (!parse_uint(min, 2))
+         return false;
+      if (s == end || *s++ != ':')
+         return false;
+      if (!parse_uint(sec, 2))
+         return false;
+   }
    result = sys_days(year_month_day{year_t{y}, month_t{m}, day_t{d}}.to_days()).time_since_epoch().count() * 86400 + h * 3600 + min * 60 + sec;
    if (eat_fractional && s != end && *s == '.') {
       ++s;
@@ -349,13 +534,24 @@ inline std::string microseconds_to_str(uint64_t microseconds) {
    return string_to_symbol_code(result, pos, end, true);
 }
 
-inline std::string symbol_code_to_string(uint64_t v) {
-   std::string result;
+// Longest text forms of a symbol_code, a symbol ("255,ABCDEFG") and an asset (a sign, "0.", 255 decimal places, a space
+// and a 7-char symbol code)
+inline constexpr size_t max_symbol_code_chars = 8;
+inline constexpr size_t max_symbol_chars      = 11;
+inline constexpr size_t max_asset_chars       = 266;
+
+// Writes the text form of a symbol_code to dest, which must have room for max_symbol_code_chars. Returns the end.
+inline char* symbol_code_to_chars(char* dest, uint64_t v) {
    while (v > 0) {
-      result += char(v & 0xFF);
+      *dest++ = char(v & 0xFF);
       v >>= 8;
    }
-   return result;
+   return dest;
+}
+
+inline std::string symbol_code_to_string(uint64_t v) {
+   char buf[max_symbol_code_chars];
+   return { buf, symbol_code_to_chars(buf, v) };
 }
 
 [[nodiscard]] inline bool string_to_symbol(uint64_t& result, uint8_t precision, const char*& pos, const char* end,
@@ -367,11 +563,13 @@ inline std::string symbol_code_to_string(uint64_t v) {
 }
 
 [[nodiscard]] inline bool string_to_symbol(uint64_t& result, const char*& pos, const char* end, bool require_end) {
-   uint8_t precision = 0;
-   bool    found     = false;
+   uint32_t precision = 0;
+   bool     found     = false;
    while (pos != end && *pos >= '0' && *pos <= '9') {
       precision = precision * 10 + (*pos - '0');
-      found     = true;
+      if (precision > 255)
+         return false;
+      found = true;
       ++pos;
    }
    if (!found || pos == end || *pos++ != ',')
@@ -383,34 +581,51 @@ inline std::string symbol_code_to_string(uint64_t v) {
    return string_to_symbol(result, pos, end, true);
 }
 
+// Writes the text form of a symbol to dest, which must have room for max_symbol_chars. Returns the end.
+inline char* symbol_to_chars(char* dest, uint64_t v) {
+   char  digits[3];
+   char* begin = write_decimal_backward(digits + 3, v & 0xff);
+   dest        = std::copy(begin, digits + 3, dest);
+   *dest++     = ',';
+   return symbol_code_to_chars(dest, v >> 8);
+}
+
 inline std::string symbol_to_string(uint64_t v) {
-   return std::to_string(v & 0xff) + "," + eosio::symbol_code_to_string(v >> 8);
+   char buf[max_symbol_chars];
+   return { buf, symbol_to_chars(buf, v) };
 }
 
+// Parses the amount and precision in one pass. Fails if the amount doesn't fit in an int64_t or there are more than 255
+// decimal places.
 [[nodiscard]] inline bool string_to_asset(int64_t& amount, uint64_t& symbol, const char*& s, const char* end,
                                           bool expect_end) {
-   // todo: check overflow
    while (s != end && *s == ' ') //
       ++s;
    uint64_t uamount   = 0;
-   uint8_t  precision = 0;
+   uint32_t precision = 0;
    bool     negative  = false;
    if (s != end && *s == '-') {
       ++s;
       negative = true;
    }
-   while (s != end && *s >= '0' && *s <= '9') //
-      uamount = uamount * 10 + (*s++ - '0');
+   const uint64_t limit = negative ? uint64_t(1) << 63 : (uint64_t(1) << 63) - 1;
+   auto add_digit = [&](uint32_t digit) {
+      if (uamount > (limit - digit) / 10)
+         return false;
+      uamount = uamount * 10 + digit;
+      return true;
+   };
+   while (s != end && *s >= '0' && *s <= '9')
+      if (!add_digit(*s++ - '0'))
+         return false;
    if (s != end && *s == '.') {
       ++s;
       while (s != end && *s >= '0' && *s <= '9') {
-         uamount = uamount * 10 + (*s++ - '0');
-         ++precision;
+         if (!add_digit(*s++ - '0') || ++precision > 255)
+            return false;
       }
    }
-   if (negative)
-      uamount = -uamount;
-   amount = uamount;
+   amount = negative ? -uamount : uamount;
    uint64_t code;
    if (!eosio::string_to_symbol_code(code, s, end, expect_end))
       return false;
@@ -422,29 +637,33 @@ inline std::string symbol_to_string(uint64_t v) {
    return string_to_asset(amount, symbol, s, end, true);
 }
 
-inline std::string asset_to_string(int64_t amount, uint64_t symbol) {
-   std::string result;
-   uint64_t    uamount;
+// Writes the text form of an asset to dest, which must have room for max_asset_chars. Returns the end.
+inline char* asset_to_chars(char* dest, int64_t amount, uint64_t symbol) {
+   uint64_t uamount    = amount < 0 ? -uint64_t(amount) : amount;
+   size_t   precision  = uint8_t(symbol);
+   char     digits[20];
+   char*    digits_end = digits + sizeof(digits);
+   char*    pos        = write_decimal_backward(digits_end, uamount);
    if (amount < 0)
-      uamount = -amount;
-   else
-      uamount = amount;
-   uint8_t precision = symbol;
+      *dest++ = '-';
+   if (size_t(digits_end - pos) > precision) {
+      dest = std::copy(pos, digits_end - precision, dest);
+      pos  = digits_end - precision;
+   } else {
+      *dest++ = '0';
+   }
    if (precision) {
-      while (precision--) {
-         result += '0' + uamount % 10;
-         uamount /= 10;
-      }
-      result += '.';
+      *dest++ = '.';
+      dest    = std::fill_n(dest, precision - (digits_end - pos), '0');
+      dest    = std::copy(pos, digits_end, dest);
    }
-   do {
-      result += '0' + uamount % 10;
-      uamount /= 10;
-   } while (uamount);
-   if (amount < 0)
-      result += '-';
-   std::reverse(result.begin(), result.end());
-   return result + ' ' + eosio::symbol_code_to_string(symbol >> 8);
+   *dest++ = ' ';
+   return symbol_code_to_chars(dest, symbol >> 8);
+}
+
+inline std::string asset_to_string(int64_t amount, uint64_t symbol) {
+   char buf[max_asset_chars];
+   return { buf, asset_to_chars(buf, amount, symbol) };
 }
 
 } // namespace eosio
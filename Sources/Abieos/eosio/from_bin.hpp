@@ -215,8 +215,12 @@ void from_bin(std::variant<Ts...>& obj, S& stream) {
 
 template <typename T, std::size_t N, typename S>
 void from_bin(std::array<T, N>& obj, S& stream) {
-   for (T& elem : obj) {
-      from_bin(elem, stream);
+   if constexpr (has_bitwise_serialization<T>()) {
+      stream.read(reinterpret_cast<char*>(obj.data()), N * sizeof(T));
+   } else {
+      for (T& elem : obj) {
+         from_bin(elem, stream);
+      }
    }
 }
 
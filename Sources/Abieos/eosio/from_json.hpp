@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdlib>
 #include "for_each_field.hpp"
 #include "check.hpp"
@@ -44,6 +45,7 @@ enum class from_json_error {
    unexpected_field,
    number_out_of_range,
    from_json_no_pair,
+   expected_base64_string,
 
    // These are from rapidjson:
    document_empty,
@@ -99,6 +101,7 @@ constexpr inline std::string_view convert_json_error(from_json_error e) {
             case from_json_error::unexpected_field:                    return "Unexpected field";
             case from_json_error::number_out_of_range:                 return "number is out of range";
             case from_json_error::from_json_no_pair:                   return "from_json does not support std::pair";
+            case from_json_error::expected_base64_string:              return "Expected string containing base64";
 
             case from_json_error::document_empty:                      return "The document is empty";
             case from_json_error::document_root_not_singular:          return "The document root must not follow by other values";
@@ -191,6 +194,32 @@ class json_token_stream : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
 
    bool complete() { return reader.IterativeParseComplete(); }
 
+   // Starts over on another json, keeping the parser's memory. Does nothing and returns false unless the previous
+   // json parsed to the end without error; otherwise the parser may still hold state from it.
+   bool reset(char* json) {
+      if (!reader.IterativeParseComplete() || reader.HasParseError())
+         return false;
+      ss = rapidjson::InsituStringStream{ json };
+      reader.IterativeParseInit();
+      current_token = {};
+      return true;
+   }
+
+   // Offset of the next unread character from where the input starts
+   size_t tell() { return ss.Tell(); }
+
+   // Continues parsing at json, after the unread input has been moved there. If a token has been peeked, the buffer
+   // holding it must have moved by shift bytes.
+   void move_input(char* json, std::ptrdiff_t shift) {
+      ss = rapidjson::InsituStringStream{ json };
+      if (current_token.key.data())
+         current_token.key = { current_token.key.data() + shift, current_token.key.size() };
+      if (current_token.value_string.data())
+         current_token.value_string = { current_token.value_string.data() + shift, current_token.value_string.size() };
+   }
+
+   bool token_peeked() const { return current_token.type != json_token_type::type_unread; }
+
    std::reference_wrapper<const json_token> peek_token() {
       if (current_token.type != json_token_type::type_unread)
          return current_token;
@@ -597,6 +626,63 @@ void from_json(std::variant<T...>& result, S& stream) {
 }
 
 /// \group from_json_explicit
+// Size of the data which a base64 or base64url string holds, or -1 if it can't be one. Padding is optional.
+inline std::ptrdiff_t base64_decoded_size(std::string_view s) {
+   if (s.size() % 4 == 0 && s.size() && s.back() == '=')
+      s.remove_suffix(s.size() >= 2 && s[s.size() - 2] == '=' ? 2 : 1);
+   if (s.size() % 4 == 1)
+      return -1;
+   return s.size() / 4 * 3 + (s.size() % 4 ? s.size() % 4 - 1 : 0);
+}
+
+// Decodes a base64 string, or a base64url one if url is set, into dest, which must have room for
+// base64_decoded_size(s) bytes. Padding is optional.
+[[nodiscard]] inline bool unbase64(char* dest, std::string_view s, bool url) {
+   static constexpr auto make_values = [](char c62, char c63) {
+      std::array<uint8_t, 256> result{};
+      for (auto& v : result)
+         v = 0xff;
+      for (int i = 0; i < 26; ++i) {
+         result['A' + i] = i;
+         result['a' + i] = 26 + i;
+      }
+      for (int i = 0; i < 10; ++i)
+         result['0' + i] = 52 + i;
+      result[uint8_t(c62)] = 62;
+      result[uint8_t(c63)] = 63;
+      return result;
+   };
+   static constexpr auto standard_values = make_values('+', '/');
+   static constexpr auto url_values      = make_values('-', '_');
+   auto& values = url ? url_values : standard_values;
+   if (s.size() % 4 == 0 && s.size() && s.back() == '=')
+      s.remove_suffix(s.size() >= 2 && s[s.size() - 2] == '=' ? 2 : 1);
+   auto*   in            = reinterpret_cast<const uint8_t*>(s.data());
+   auto*   end           = in + s.size() - s.size() % 4;
+   uint8_t bad           = 0;
+   bool    trailing_bits = false;
+   for (; in != end; in += 4, dest += 3) {
+      uint8_t a = values[in[0]], b = values[in[1]], c = values[in[2]], d = values[in[3]];
+      bad |= a | b | c | d;
+      uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+      dest[0]    = char(v >> 16);
+      dest[1]    = char(v >> 8);
+      dest[2]    = char(v);
+   }
+   if (s.size() % 4 >= 2) {
+      uint8_t a = values[in[0]], b = values[in[1]], c = s.size() % 4 == 3 ? values[in[2]] : 0;
+      bad |= a | b | c;
+      // The unused low bits must be 0, so that each value has one encoding
+      trailing_bits = s.size() % 4 == 2 ? (b & 0x0f) : (c & 0x03);
+      dest[0] = char((a << 2) | (b >> 4));
+      if (s.size() % 4 == 3)
+         dest[1] = char((b << 4) | (c >> 2));
+   } else if (s.size() % 4 == 1) {
+      return false;
+   }
+   return !(bad & 0xc0) && !trailing_bits;
+}
+
 template <typename S>
 void from_json_hex(std::vector<char>& result, S& stream) {
    auto s = stream.get_string();
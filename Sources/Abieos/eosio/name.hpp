@@ -158,7 +158,11 @@ void from_json(name& obj, S& stream) {
 
 template <typename S>
 void to_json(const name& obj, S& stream) {
-   to_json(eosio::name_to_string(obj.value), stream);
+   char buf[max_name_chars];
+   auto size = name_to_chars(buf, obj.value);
+   stream.write('"');
+   stream.write(buf, size);
+   stream.write('"');
 }
 
 inline namespace literals {
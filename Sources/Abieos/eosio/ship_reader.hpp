@@ -0,0 +1,590 @@
+#pragma once
+
+#include "ship_protocol.hpp"
+
+#include <algorithm>
+
+// Zero-copy views over state-history (ship) messages.
+//
+// The types in this file mirror the ones in ship_protocol.hpp, but every string, byte blob and
+// vector is left in the original buffer: strings become std::string_view, bytes stay as
+// input_stream and vectors become array_view<T>, which is decoded element by element on demand.
+// None of the views own memory; the message buffer must outlive them.
+namespace eosio { namespace ship_protocol {
+
+   // Serialized size of element types which array_view skips without decoding; 0 if it varies.
+   template <typename T>
+   constexpr uint32_t fixed_bin_size = 0;
+   template <>
+   constexpr uint32_t fixed_bin_size<permission_level> = 16;
+   template <>
+   constexpr uint32_t fixed_bin_size<account_auth_sequence> = 16;
+   template <>
+   constexpr uint32_t fixed_bin_size<account_delta> = 16;
+
+   // Moves past one serialized T. The default decodes into a temporary; overloads for specific
+   // types skip by length arithmetic instead.
+   template <typename T, typename S>
+   void skip_bin(T*, S& stream) {
+      if constexpr (fixed_bin_size<T> != 0) {
+         stream.skip(fixed_bin_size<T>);
+      } else {
+         T tmp{};
+         from_bin(tmp, stream);
+      }
+   }
+
+   // A serialized vector<T>. from_bin skips over the elements to find the end of the array;
+   // for_each decodes them, one at a time, into a single T.
+   template <typename T>
+   struct array_view {
+      uint32_t            size = {};
+      eosio::input_stream data = {};
+
+      bool empty() const { return !size; }
+
+      template <typename F>
+      void for_each(F&& f) const {
+         auto s = data;
+         for (uint32_t i = 0; i < size; ++i) {
+            T obj{};
+            from_bin(obj, s);
+            f(obj);
+         }
+      }
+   };
+
+   template <typename T, typename S>
+   void from_bin(array_view<T>& obj, S& stream) {
+      varuint32_from_bin(obj.size, stream);
+      auto begin = stream.pos;
+      if constexpr (fixed_bin_size<T> != 0) {
+         stream.skip(uint64_t(obj.size) * fixed_bin_size<T>);
+      } else {
+         for (uint32_t i = 0; i < obj.size; ++i)
+            skip_bin((T*)nullptr, stream);
+      }
+      obj.data = { begin, stream.pos };
+   }
+
+   struct table_delta_v0_view {
+      std::string_view name = {};
+      array_view<row>  rows = {};
+   };
+
+   EOSIO_REFLECT(table_delta_v0_view, name, rows)
+
+   using table_delta_view = std::variant<table_delta_v0_view>;
+
+   struct action_view {
+      eosio::name                  account       = {};
+      eosio::name                  name          = {};
+      array_view<permission_level> authorization = {};
+      eosio::input_stream          data          = {};
+   };
+
+   EOSIO_REFLECT(action_view, account, name, authorization, data)
+
+   struct action_receipt_v0_view {
+      eosio::name                       receiver        = {};
+      eosio::checksum256                act_digest      = {};
+      uint64_t                          global_sequence = {};
+      uint64_t                          recv_sequence   = {};
+      array_view<account_auth_sequence> auth_sequence   = {};
+      eosio::varuint32                  code_sequence   = {};
+      eosio::varuint32                  abi_sequence    = {};
+   };
+
+   EOSIO_REFLECT(action_receipt_v0_view, receiver, act_digest, global_sequence, recv_sequence, auth_sequence,
+                 code_sequence, abi_sequence)
+
+   using action_receipt_view = std::variant<action_receipt_v0_view>;
+
+   struct action_trace_v0_view {
+      eosio::varuint32                   action_ordinal         = {};
+      eosio::varuint32                   creator_action_ordinal = {};
+      std::optional<action_receipt_view> receipt                = {};
+      eosio::name                        receiver               = {};
+      action_view                        act                    = {};
+      bool                               context_free           = {};
+      int64_t                            elapsed                = {};
+      std::string_view                   console                = {};
+      array_view<account_delta>          account_ram_deltas     = {};
+      std::optional<std::string_view>    except                 = {};
+      std::optional<uint64_t>            error_code             = {};
+   };
+
+   EOSIO_REFLECT(action_trace_v0_view, action_ordinal, creator_action_ordinal, receipt, receiver, act, context_free,
+                 elapsed, console, account_ram_deltas, except, error_code)
+
+   struct action_trace_v1_view {
+      eosio::varuint32                   action_ordinal         = {};
+      eosio::varuint32                   creator_action_ordinal = {};
+      std::optional<action_receipt_view> receipt                = {};
+      eosio::name                        receiver               = {};
+      action_view                        act                    = {};
+      bool                               context_free           = {};
+      int64_t                            elapsed                = {};
+      std::string_view                   console                = {};
+      array_view<account_delta>          account_ram_deltas     = {};
+      array_view<account_delta>          account_disk_deltas    = {};
+      std::optional<std::string_view>    except                 = {};
+      std::optional<uint64_t>            error_code             = {};
+      eosio::input_stream                return_value           = {};
+   };
+
+   EOSIO_REFLECT(action_trace_v1_view, action_ordinal, creator_action_ordinal, receipt, receiver, act, context_free,
+                 elapsed, console, account_ram_deltas, account_disk_deltas, except, error_code, return_value)
+
+   using action_trace_view = std::variant<action_trace_v0_view, action_trace_v1_view>;
+
+   struct action_trace_names {
+      eosio::name receiver = {};
+      eosio::name account  = {};
+      eosio::name name     = {};
+   };
+
+   inline void skip_varuint(eosio::input_stream& stream) {
+      uint64_t v;
+      varuint64_from_bin(v, stream);
+   }
+
+   inline void skip_bytes(eosio::input_stream& stream) {
+      uint64_t size;
+      varuint64_from_bin(size, stream);
+      stream.skip(size);
+   }
+
+   inline void skip_array(eosio::input_stream& stream, uint32_t element_size) {
+      uint32_t size;
+      varuint32_from_bin(size, stream);
+      stream.skip(uint64_t(size) * element_size);
+   }
+
+   inline bool read_present(eosio::input_stream& stream) {
+      bool present;
+      from_bin(present, stream);
+      return present;
+   }
+
+   // Moves past a serialized action_trace without decoding it and returns the names used for
+   // filtering. Everything but the receipt is at a fixed offset or behind a length prefix.
+   inline action_trace_names skip_action_trace(eosio::input_stream& stream) {
+      uint32_t version;
+      varuint32_from_bin(version, stream);
+      check(version < std::variant_size_v<action_trace_view>, convert_stream_error(stream_error::bad_variant_index));
+      skip_varuint(stream); // action_ordinal
+      skip_varuint(stream); // creator_action_ordinal
+      if (read_present(stream)) {
+         uint32_t receipt_version;
+         varuint32_from_bin(receipt_version, stream);
+         check(receipt_version == 0, convert_stream_error(stream_error::bad_variant_index));
+         stream.skip(8 + 32 + 8 + 8); // receiver, act_digest, global_sequence, recv_sequence
+         skip_array(stream, fixed_bin_size<account_auth_sequence>);
+         skip_varuint(stream); // code_sequence
+         skip_varuint(stream); // abi_sequence
+      }
+      action_trace_names result;
+      stream.read_raw(result.receiver.value);
+      stream.read_raw(result.account.value);
+      stream.read_raw(result.name.value);
+      skip_array(stream, fixed_bin_size<permission_level>);
+      skip_bytes(stream);   // data
+      stream.skip(1 + 8);   // context_free, elapsed
+      skip_bytes(stream);   // console
+      skip_array(stream, fixed_bin_size<account_delta>);
+      if (version == 1)
+         skip_array(stream, fixed_bin_size<account_delta>);
+      if (read_present(stream))
+         skip_bytes(stream);  // except
+      if (read_present(stream))
+         stream.skip(8);      // error_code
+      if (version == 1)
+         skip_bytes(stream);  // return_value
+      return result;
+   }
+
+   template <typename S>
+   void skip_bin(action_trace_view*, S& stream) {
+      skip_action_trace(stream);
+   }
+
+   struct prunable_data_view {
+      struct none {
+         eosio::checksum256 prunable_digest;
+      };
+
+      struct partial {
+         array_view<eosio::signature>                 signatures;
+         array_view<prunable_data_type::segment_type> context_free_segments;
+      };
+
+      struct full {
+         array_view<eosio::signature>    signatures;
+         array_view<eosio::input_stream> context_free_segments;
+      };
+
+      struct full_legacy {
+         array_view<eosio::signature> signatures;
+         eosio::input_stream          packed_context_free_data;
+      };
+
+      using prunable_data_t = std::variant<full_legacy, none, partial, full>;
+
+      prunable_data_t prunable_data;
+   };
+
+   EOSIO_REFLECT(prunable_data_view, prunable_data)
+   EOSIO_REFLECT(prunable_data_view::none, prunable_digest)
+   EOSIO_REFLECT(prunable_data_view::partial, signatures, context_free_segments)
+   EOSIO_REFLECT(prunable_data_view::full, signatures, context_free_segments)
+   EOSIO_REFLECT(prunable_data_view::full_legacy, signatures, packed_context_free_data)
+
+   struct partial_transaction_v0_view {
+      eosio::time_point_sec           expiration             = {};
+      uint16_t                        ref_block_num          = {};
+      uint32_t                        ref_block_prefix       = {};
+      eosio::varuint32                max_net_usage_words    = {};
+      uint8_t                         max_cpu_usage_ms       = {};
+      eosio::varuint32                delay_sec              = {};
+      array_view<extension>           transaction_extensions = {};
+      array_view<eosio::signature>    signatures             = {};
+      array_view<eosio::input_stream> context_free_data      = {};
+   };
+
+   EOSIO_REFLECT(partial_transaction_v0_view, expiration, ref_block_num, ref_block_prefix, max_net_usage_words,
+                 max_cpu_usage_ms, delay_sec, transaction_extensions, signatures, context_free_data)
+
+   struct partial_transaction_v1_view {
+      eosio::time_point_sec             expiration             = {};
+      uint16_t                          ref_block_num          = {};
+      uint32_t                          ref_block_prefix       = {};
+      eosio::varuint32                  max_net_usage_words    = {};
+      uint8_t                           max_cpu_usage_ms       = {};
+      eosio::varuint32                  delay_sec              = {};
+      array_view<extension>             transaction_extensions = {};
+      std::optional<prunable_data_view> prunable_data          = {};
+   };
+
+   EOSIO_REFLECT(partial_transaction_v1_view, expiration, ref_block_num, ref_block_prefix, max_net_usage_words,
+                 max_cpu_usage_ms, delay_sec, transaction_extensions, prunable_data)
+
+   using partial_transaction_view = std::variant<partial_transaction_v0_view, partial_transaction_v1_view>;
+
+   struct recurse_transaction_trace_view;
+
+   struct transaction_trace_v0_view {
+      eosio::checksum256                         id                = {};
+      transaction_status                         status            = {};
+      uint32_t                                   cpu_usage_us      = {};
+      eosio::varuint32                           net_usage_words   = {};
+      int64_t                                    elapsed           = {};
+      uint64_t                                   net_usage         = {};
+      bool                                       scheduled         = {};
+      array_view<action_trace_view>              action_traces     = {};
+      std::optional<account_delta>               account_ram_delta = {};
+      std::optional<std::string_view>            except            = {};
+      std::optional<uint64_t>                    error_code        = {};
+      array_view<recurse_transaction_trace_view> failed_dtrx_trace = {};
+      std::optional<partial_transaction_view>    partial           = {};
+   };
+
+   EOSIO_REFLECT(transaction_trace_v0_view, id, status, cpu_usage_us, net_usage_words, elapsed, net_usage, scheduled,
+                 action_traces, account_ram_delta, except, error_code, failed_dtrx_trace, partial)
+
+   using transaction_trace_view = std::variant<transaction_trace_v0_view>;
+
+   struct recurse_transaction_trace_view {
+      transaction_trace_view recurse = {};
+   };
+
+   template <typename S>
+   void from_bin(recurse_transaction_trace_view& obj, S& stream) {
+      return from_bin(obj.recurse, stream);
+   }
+
+   struct producer_schedule_view {
+      uint32_t                 version   = {};
+      array_view<producer_key> producers = {};
+   };
+
+   EOSIO_REFLECT(producer_schedule_view, version, producers)
+
+   struct packed_transaction_v0_view {
+      array_view<eosio::signature> signatures               = {};
+      uint8_t                      compression              = {};
+      eosio::input_stream          packed_context_free_data = {};
+      eosio::input_stream          packed_trx               = {};
+   };
+
+   EOSIO_REFLECT(packed_transaction_v0_view, signatures, compression, packed_context_free_data, packed_trx)
+
+   struct packed_transaction_view {
+      uint8_t             compression   = {};
+      prunable_data_view  prunable_data = {};
+      eosio::input_stream packed_trx    = {};
+   };
+
+   EOSIO_REFLECT(packed_transaction_view, compression, prunable_data, packed_trx)
+
+   struct transaction_receipt_v0_view : transaction_receipt_header {
+      std::variant<eosio::checksum256, packed_transaction_v0_view> trx = {};
+   };
+
+   EOSIO_REFLECT(transaction_receipt_v0_view, base transaction_receipt_header, trx)
+
+   struct transaction_receipt_view : transaction_receipt_header {
+      std::variant<eosio::checksum256, packed_transaction_view> trx = {};
+   };
+
+   EOSIO_REFLECT(transaction_receipt_view, base transaction_receipt_header, trx)
+
+   struct block_header_view {
+      eosio::block_timestamp                timestamp{};
+      eosio::name                           producer          = {};
+      uint16_t                              confirmed         = {};
+      eosio::checksum256                    previous          = {};
+      eosio::checksum256                    transaction_mroot = {};
+      eosio::checksum256                    action_mroot      = {};
+      uint32_t                              schedule_version  = {};
+      std::optional<producer_schedule_view> new_producers     = {};
+      array_view<extension>                 header_extensions = {};
+   };
+
+   EOSIO_REFLECT(block_header_view, timestamp, producer, confirmed, previous, transaction_mroot, action_mroot,
+                 schedule_version, new_producers, header_extensions)
+
+   struct signed_block_header_view : block_header_view {
+      eosio::signature producer_signature = {};
+   };
+
+   EOSIO_REFLECT(signed_block_header_view, base block_header_view, producer_signature)
+
+   struct signed_block_v0_view : signed_block_header_view {
+      array_view<transaction_receipt_v0_view> transactions     = {};
+      array_view<extension>                   block_extensions = {};
+   };
+
+   EOSIO_REFLECT(signed_block_v0_view, base signed_block_header_view, transactions, block_extensions)
+
+   struct signed_block_v1_view : signed_block_header_view {
+      uint8_t                              prune_state      = {};
+      array_view<transaction_receipt_view> transactions     = {};
+      array_view<extension>                block_extensions = {};
+   };
+
+   EOSIO_REFLECT(signed_block_v1_view, base signed_block_header_view, prune_state, transactions, block_extensions)
+
+   using signed_block_variant_view = std::variant<signed_block_v0_view, signed_block_v1_view>;
+
+   struct get_blocks_result_v1_view : get_blocks_result_base {
+      std::optional<signed_block_variant_view> block  = {};
+      eosio::input_stream                      traces = {};
+      eosio::input_stream                      deltas = {};
+   };
+
+   EOSIO_REFLECT(get_blocks_result_v1_view, base get_blocks_result_base, block, traces, deltas)
+
+   using result_view = std::variant<get_status_result_v0, get_blocks_result_v0, get_blocks_result_v1_view>;
+
+   // A get_blocks_result of either version. traces and deltas hold a serialized
+   // vector<transaction_trace> and vector<table_delta>; they are empty when not requested.
+   struct blocks_result_view : get_blocks_result_base {
+      std::optional<signed_block_variant_view> block  = {};
+      eosio::input_stream                      traces = {};
+      eosio::input_stream                      deltas = {};
+   };
+
+   // Decodes one serialized result. Returns false if it is not a get_blocks_result.
+   inline bool read_blocks_result(eosio::input_stream bin, blocks_result_view& result) {
+      result_view r;
+      from_bin(r, bin);
+      if (auto* v0 = std::get_if<get_blocks_result_v0>(&r)) {
+         static_cast<get_blocks_result_base&>(result) = *v0;
+         result.block.reset();
+         if (v0->block) {
+            auto& block = result.block.emplace(std::in_place_index<0>);
+            from_bin(std::get<0>(block), *v0->block);
+         }
+         result.traces = v0->traces.value_or(eosio::input_stream{});
+         result.deltas = v0->deltas.value_or(eosio::input_stream{});
+         return true;
+      } else if (auto* v1 = std::get_if<get_blocks_result_v1_view>(&r)) {
+         static_cast<get_blocks_result_base&>(result) = *v1;
+         result.block  = std::move(v1->block);
+         result.traces = v1->traces;
+         result.deltas = v1->deltas;
+         return true;
+      }
+      return false;
+   }
+
+   template <typename F>
+   void for_each_transaction_trace(eosio::input_stream traces, F&& f) {
+      if (!traces.remaining())
+         return;
+      uint32_t size;
+      varuint32_from_bin(size, traces);
+      for (uint32_t i = 0; i < size; ++i) {
+         transaction_trace_view trace;
+         from_bin(trace, traces);
+         f(std::get<transaction_trace_v0_view>(trace));
+      }
+   }
+
+   // Visits the action traces of a transaction trace; f receives an action_trace_view.
+   template <typename F>
+   void for_each_action_trace(const transaction_trace_v0_view& trace, F&& f) {
+      trace.action_traces.for_each(f);
+   }
+
+   template <typename F>
+   void for_each_table_delta(eosio::input_stream deltas, F&& f) {
+      if (!deltas.remaining())
+         return;
+      uint32_t size;
+      varuint32_from_bin(size, deltas);
+      for (uint32_t i = 0; i < size; ++i) {
+         table_delta_view delta;
+         from_bin(delta, deltas);
+         f(std::get<table_delta_v0_view>(delta));
+      }
+   }
+
+   // A sorted set of names. An empty set matches every name.
+   class name_filter {
+    public:
+      name_filter() = default;
+      name_filter(std::initializer_list<eosio::name> names) {
+         for (auto n : names)
+            insert(n);
+      }
+
+      void insert(eosio::name n) {
+         auto it = std::lower_bound(names.begin(), names.end(), n.value);
+         if (it == names.end() || *it != n.value)
+            names.insert(it, n.value);
+      }
+
+      bool empty() const { return names.empty(); }
+
+      bool matches(eosio::name n) const {
+         return names.empty() || std::binary_search(names.begin(), names.end(), n.value);
+      }
+
+    private:
+      std::vector<uint64_t> names;
+   };
+
+   // Selects contract rows by code, scope and table, and action traces by account (code) and action
+   // name. Matching only looks at names which are at a fixed offset in the serialized form.
+   struct ship_filter {
+      name_filter code   = {};
+      name_filter scope  = {};
+      name_filter table  = {};
+      name_filter action = {};
+
+      // contract_table, contract_row and contract_index* rows all start with code, scope and table.
+      bool match_contract_row(eosio::input_stream data) const {
+         uint32_t version;
+         varuint32_from_bin(version, data);
+         uint64_t names[3];
+         data.read(names, sizeof(names));
+         return code.matches(eosio::name{ names[0] }) && scope.matches(eosio::name{ names[1] }) &&
+                table.matches(eosio::name{ names[2] });
+      }
+
+      bool match_action(const action_trace_names& names) const {
+         return code.matches(names.account) && action.matches(names.name);
+      }
+   };
+
+   inline bool is_contract_table(std::string_view delta_name) {
+      return delta_name.substr(0, 9) == "contract_";
+   }
+
+   // Visits the action traces which pass the filter in a serialized vector<transaction_trace>, such as
+   // get_blocks_result_v0::traces. Each trace is walked once: the filter is applied while skipping over
+   // action_traces, so only the matching traces are decoded. Failed deferred transaction traces are not
+   // visited.
+   template <typename F>
+   void for_each_action_trace(eosio::input_stream traces, const ship_filter& filter, F&& f) {
+      if (!traces.remaining())
+         return;
+      uint32_t size;
+      varuint32_from_bin(size, traces);
+      for (uint32_t i = 0; i < size; ++i) {
+         uint32_t version;
+         varuint32_from_bin(version, traces);
+         check(version < std::variant_size_v<transaction_trace_view>,
+               convert_stream_error(stream_error::bad_variant_index));
+         traces.skip(32 + 1 + 4); // id, status, cpu_usage_us
+         skip_varuint(traces);    // net_usage_words
+         traces.skip(8 + 8 + 1);  // elapsed, net_usage, scheduled
+         uint32_t num_actions;
+         varuint32_from_bin(num_actions, traces);
+         for (uint32_t j = 0; j < num_actions; ++j) {
+            auto begin = traces.pos;
+            if (filter.match_action(skip_action_trace(traces))) {
+               eosio::input_stream bin{ begin, traces.pos };
+               action_trace_view   action_trace;
+               from_bin(action_trace, bin);
+               f(action_trace);
+            }
+         }
+         std::optional<account_delta>               account_ram_delta;
+         std::optional<std::string_view>            except;
+         std::optional<uint64_t>                    error_code;
+         array_view<recurse_transaction_trace_view> failed_dtrx_trace;
+         std::optional<partial_transaction_view>    partial;
+         from_bin(account_ram_delta, traces);
+         from_bin(except, traces);
+         from_bin(error_code, traces);
+         from_bin(failed_dtrx_trace, traces);
+         from_bin(partial, traces);
+      }
+   }
+
+   // Visits the rows of a contract_* delta which pass the filter; f receives the row, whose data is
+   // still serialized. Deltas of other tables are ignored.
+   template <typename F>
+   void for_each_contract_row(const table_delta_v0_view& delta, const ship_filter& filter, F&& f) {
+      if (!is_contract_table(delta.name))
+         return;
+      auto stream = delta.rows.data;
+      for (uint32_t i = 0; i < delta.rows.size; ++i) {
+         row r;
+         from_bin(r, stream);
+         if (filter.match_contract_row(r.data))
+            f(r);
+      }
+   }
+
+   // Reads a sequence of results, each preceded by its size as a little-endian uint32. This is the
+   // layout of a recorded ship session: the websocket message payloads written back to back.
+   class blocks_result_reader {
+    public:
+      explicit blocks_result_reader(eosio::input_stream messages) : messages{ messages } {}
+
+      // Decodes the next get_blocks_result; status results are skipped. Returns false at the end
+      // of the input.
+      bool next(blocks_result_view& result) {
+         while (messages.remaining()) {
+            uint32_t size;
+            messages.read_raw(size);
+            eosio::input_stream message;
+            messages.read_reuse_storage(message.pos, size);
+            message.end = message.pos + size;
+            if (read_blocks_result(message, result))
+               return true;
+         }
+         return false;
+      }
+
+      size_t remaining() const { return messages.remaining(); }
+
+    private:
+      eosio::input_stream messages;
+   };
+
+}} // namespace eosio::ship_protocol
@@ -10,6 +10,7 @@
 #include "name.hpp"
 #include "operators.hpp"
 #include "reflection.hpp"
+#include "to_json.hpp"
 
 #include <limits>
 #include <string_view>
@@ -169,7 +170,8 @@ EOSIO_COMPARE(symbol_code);
 
 template <typename S>
 void to_json(const symbol_code& obj, S& stream) {
-   to_json(symbol_code_to_string(obj.value), stream);
+   char buf[max_symbol_code_chars];
+   plain_string_to_json({ buf, size_t(symbol_code_to_chars(buf, obj.value) - buf) }, stream);
 }
 
 template <typename S>
@@ -247,7 +249,8 @@ EOSIO_COMPARE(symbol);
 
 template <typename S>
 void to_json(const symbol& obj, S& stream) {
-   to_json(symbol_to_string(obj.value), stream);
+   char buf[max_symbol_chars];
+   plain_string_to_json({ buf, size_t(symbol_to_chars(buf, obj.value) - buf) }, stream);
 }
 
 template <typename S>
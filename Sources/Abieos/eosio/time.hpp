@@ -4,6 +4,7 @@
 #include "operators.hpp"
 #include "reflection.hpp"
 #include "from_json.hpp"
+#include "to_json.hpp"
 #include <stdint.h>
 #include <string>
 
@@ -99,7 +100,8 @@ void from_json(time_point& obj, S& stream) {
 
 template <typename S>
 void to_json(const time_point& obj, S& stream) {
-   return to_json(eosio::microseconds_to_str(obj.elapsed._count), stream);
+   char buf[time_point_chars];
+   plain_string_to_json({ buf, size_t(microseconds_to_chars(buf, obj.elapsed._count) - buf) }, stream);
 }
 
 /**
@@ -178,7 +180,9 @@ void from_json(time_point_sec& obj, S& stream) {
 
 template <typename S>
 void to_json(const time_point_sec& obj, S& stream) {
-   return to_json(eosio::microseconds_to_str(uint64_t(obj.utc_seconds) * 1'000'000), stream);
+   char buf[time_point_chars];
+   plain_string_to_json({ buf, size_t(microseconds_to_chars(buf, uint64_t(obj.utc_seconds) * 1'000'000) - buf) },
+                        stream);
 }
 
 /**
@@ -73,6 +73,18 @@ void to_json(const char* s, S& stream) {
    to_json(std::string_view{ s }, stream);
 }
 
+// Same as to_json(std::string_view), but writes s as is when it's printable ascii without quotes or backslashes, as the
+// text forms of symbols and assets almost always are
+template <typename S>
+void plain_string_to_json(std::string_view s, S& stream) {
+   for (char c : s)
+      if ((unsigned char)c < 32 || (unsigned char)c >= 127 || c == '"' || c == '\\')
+         return to_json(s, stream);
+   stream.write('"');
+   stream.write(s.data(), s.size());
+   stream.write('"');
+}
+
 /*
 template <typename S>
 result<void> to_json(const shared_memory<std::string_view>& s, S& stream) {
@@ -270,6 +282,42 @@ void to_json_hex(const char* data, size_t size, S& stream) {
    stream.write('"');
 }
 
+// Writes data as a base64 string (RFC 4648), with padding, or in the url-safe alphabet without padding
+template <typename S>
+void to_json_base64(const char* data, size_t size, bool url, S& stream) {
+   const char* digits = url ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+                            : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+   stream.write('"');
+   char   buf[256];
+   size_t n   = 0;
+   auto   end = data + size - size % 3;
+   for (; data != end; data += 3) {
+      uint32_t v = (uint8_t(data[0]) << 16) | (uint8_t(data[1]) << 8) | uint8_t(data[2]);
+      buf[n]     = digits[v >> 18];
+      buf[n + 1] = digits[(v >> 12) & 63];
+      buf[n + 2] = digits[(v >> 6) & 63];
+      buf[n + 3] = digits[v & 63];
+      if ((n += 4) == sizeof(buf)) {
+         stream.write(buf, n);
+         n = 0;
+      }
+   }
+   if (size % 3) {
+      uint32_t v = (uint8_t(data[0]) << 16) | (size % 3 == 2 ? uint8_t(data[1]) << 8 : 0);
+      buf[n++]   = digits[v >> 18];
+      buf[n++]   = digits[(v >> 12) & 63];
+      if (size % 3 == 2)
+         buf[n++] = digits[(v >> 6) & 63];
+      if (!url) {
+         buf[n++] = '=';
+         if (size % 3 == 1)
+            buf[n++] = '=';
+      }
+   }
+   stream.write(buf, n);
+   stream.write('"');
+}
+
 #ifdef __eosio_cdt__
 
 template <typename S> void to_json(long double value, S& stream) {
@@ -35,6 +35,13 @@ const char* abieos_get_bin_hex(abieos_context* context);
 uint64_t abieos_string_to_name(abieos_context* context, const char* str);
 const char* abieos_name_to_string(abieos_context* context, uint64_t name);
 
+// Convert count names to text in fixed 13-byte slots: names[i] goes to dest + 13 * i, padded with '\0' when shorter.
+void abieos_names_to_strings(abieos_context* context, const uint64_t* names, size_t count, char* dest);
+
+// Convert count names in 13-byte slots, as abieos_names_to_strings writes them, to dest. A name ends at the first '\0'
+// or at the end of its slot. Like abieos_string_to_name, this doesn't reject chars which can't be in a name.
+void abieos_strings_to_names(abieos_context* context, const char* src, size_t count, uint64_t* dest);
+
 // Set abi (JSON format). Returns false on error.
 abieos_bool abieos_set_abi(abieos_context* context, uint64_t contract, const char* abi);
 
@@ -44,6 +51,27 @@ abieos_bool abieos_set_abi_bin(abieos_context* context, uint64_t contract, const
 // Set abi (hex format). Returns false on error.
 abieos_bool abieos_set_abi_hex(abieos_context* context, uint64_t contract, const char* hex);
 
+// Save every loaded contract's abi to a snapshot (binary format). Loading a snapshot skips parsing and type
+// resolution, so it is faster than setting the abis it came from. Only the abieos version which saved a snapshot
+// is guaranteed to load it. Use abieos_get_bin_* to retrieve result. Returns false on error.
+abieos_bool abieos_save_snapshot(abieos_context* context);
+
+// Load every contract in a snapshot, as if by abieos_set_abi. Loads nothing if the snapshot is invalid. Returns
+// false on error.
+abieos_bool abieos_load_snapshot(abieos_context* context, const char* data, size_t size);
+
+// Memory used by a contract's abi, as reported by abieos_get_abi_memory_usage. The builtin types, and the arrays,
+// optionals and extensions of them, are shared by every contract and not counted.
+typedef struct abieos_abi_memory_usage {
+    uint64_t types;
+    uint64_t fields; // in structs and variants
+    uint64_t names;  // bytes of field and variant case names, stored once each
+    uint64_t bytes;  // estimated heap use, including allocator overhead
+} abieos_abi_memory_usage;
+
+// Get the memory used by a contract's abi. Returns false on error.
+abieos_bool abieos_get_abi_memory_usage(abieos_context* context, uint64_t contract, abieos_abi_memory_usage* usage);
+
 // Get the type name for an action. The context owns the returned memory. Returns null on error; use abieos_get_error
 // to retrieve error.
 const char* abieos_get_type_for_action(abieos_context* context, uint64_t contract, uint64_t action);
@@ -63,19 +91,184 @@ const char* abieos_get_type_for_action_result(abieos_context* context, uint64_t
 // Convert json to binary. Use abieos_get_bin_* to retrieve result. Returns false on error.
 abieos_bool abieos_json_to_bin(abieos_context* context, uint64_t contract, const char* type, const char* json);
 
+// Convert json to binary from successive chunks of input, as abieos_json_to_bin does for the whole json: call
+// abieos_json_to_bin_begin, then abieos_json_to_bin_append with each chunk (chunks may split the json anywhere), then
+// abieos_json_to_bin_finish. Each chunk is parsed as it arrives, and only the input which hasn't been parsed yet is
+// kept. An error ends the conversion, and abieos_json_to_bin_begin discards one in progress. abieos_json_to_bin_finish
+// puts the result in abieos_get_bin_*. Each returns false on error.
+abieos_bool abieos_json_to_bin_begin(abieos_context* context, uint64_t contract, const char* type);
+abieos_bool abieos_json_to_bin_append(abieos_context* context, const char* json, size_t size);
+abieos_bool abieos_json_to_bin_finish(abieos_context* context);
+
+// Convert json to hex. Same result as abieos_json_to_bin followed by abieos_get_bin_hex, but without building the
+// binary first. The context owns the returned string. Returns null on error; use abieos_get_error to retrieve error.
+const char* abieos_json_to_hex(abieos_context* context, uint64_t contract, const char* type, const char* json);
+
 // Convert json to binary. Allow json field reordering. Use abieos_get_bin_* to retrieve result. Returns false on error.
 abieos_bool abieos_json_to_bin_reorderable(abieos_context* context, uint64_t contract, const char* type,
                                            const char* json);
 
+// Convert a transaction in json to binary, as abieos_json_to_bin_reorderable does, and compute the digest which
+// signs it: sha256(chain_id || packed transaction || sha256(context_free_data)). The hash of context_free_data is 32
+// zero bytes instead if it is empty. type is a transaction type in contract's abi, as in transaction.abi.json. An
+// action's data may be an object instead of hex; it's converted as the type which the abi of the action's account
+// gives the action, so that abi must be loaded. chain_id is 32 bytes, and context_free_data is the packed context free
+// data. Writes the 32 byte digest to digest. Use abieos_get_bin_* to retrieve the packed transaction. Returns false on
+// error.
+abieos_bool abieos_transaction_json_to_bin(abieos_context* context, uint64_t contract, const char* type,
+                                           const char* json, const char* chain_id, const char* context_free_data,
+                                           size_t context_free_data_size, char* digest);
+
 // Convert binary to json. The context owns the returned string. Returns null on error; use abieos_get_error to retrieve
 // error.
 const char* abieos_bin_to_json(abieos_context* context, uint64_t contract, const char* type, const char* data,
                                size_t size);
 
+// Convert binary to json, formatting the elements of a top-level array on up to num_threads threads (0: one per
+// core). The output is identical to abieos_bin_to_json. The context owns the returned string. Returns null on error;
+// use abieos_get_error to retrieve error.
+const char* abieos_bin_to_json_parallel(abieos_context* context, uint64_t contract, const char* type,
+                                        const char* data, size_t size, uint32_t num_threads);
+
+// Receives the output of abieos_bin_to_json_stream. Returns false to stop the conversion.
+typedef abieos_bool (*abieos_write_fn)(void* user_data, const char* data, size_t size);
+
+// Convert binary to json, passing the json to write in chunks of chunk_size bytes (0: 64 KiB; the last chunk may be
+// shorter) as it is produced, instead of building the whole string. Memory use is bounded by chunk_size plus the
+// largest single string or bytes value. The output is identical to abieos_bin_to_json. On error, some output may
+// already have been written. Returns false on error.
+abieos_bool abieos_bin_to_json_stream(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                                      size_t size, size_t chunk_size, abieos_write_fn write, void* user_data);
+
+// Formats for abieos_bin_to_document
+typedef enum abieos_document_format {
+    abieos_document_cbor,    // RFC 8949
+    abieos_document_msgpack,
+} abieos_document_format;
+
+// Convert binary to cbor or msgpack, with the same structure as abieos_bin_to_json gives. Integers up to 64 bits and
+// floats are numbers instead of strings; bytes, checksums and float128 are byte strings instead of hex; assets are maps
+// of amount, precision and symbol. Other types, including int128 and uint128, are strings as in json. Use
+// abieos_get_bin_* to retrieve result. Returns false on error.
+abieos_bool abieos_bin_to_document(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                                   size_t size, abieos_document_format format);
+
+// Convert binary of from_type in from_contract's abi to binary of to_type in to_contract's abi, without going through
+// json. Struct fields and variant cases are matched by name. Fields removed from the new type are dropped; fields added
+// to it must be optionals, which are written as absent, or trailing extensions, which are left out. Renaming or
+// reordering fields, and changing the type of a field other than to an optional of the same type, are errors. The
+// conversion is compiled once for each pair of types and kept in the context. Use abieos_get_bin_* to retrieve result.
+// Returns false on error.
+abieos_bool abieos_transcode_bin(abieos_context* context, uint64_t from_contract, const char* from_type,
+                                 uint64_t to_contract, const char* to_type, const char* data, size_t size);
+
+// Check that data holds exactly one valid value of type, without converting it. Returns 0 if it does. Otherwise
+// returns an error code: a stream error (1-255) or an abi error (256 + code), as listed in eosio/stream.hpp and
+// eosio/abi.hpp, or -1 if the contract or type can not be found. Trailing data is reported as a stream underrun.
+// Use abieos_get_error to retrieve the message. Bad data is rejected without throwing internally, so this is
+// cheaper than a failing abieos_bin_to_json.
+int abieos_check_bin(abieos_context* context, uint64_t contract, const char* type, const char* data, size_t size);
+
+// Convert binary to a kv key: a byte string which sorts in the same order as the values of type (see eosio/to_key.hpp).
+// Use abieos_get_bin_* to retrieve result. Returns false on error.
+abieos_bool abieos_bin_to_key(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                              size_t size);
+
+// Convert json to a kv key. Use abieos_get_bin_* to retrieve result. Returns false on error.
+abieos_bool abieos_json_to_key(abieos_context* context, uint64_t contract, const char* type, const char* json);
+
+// Convert a sequence of binary values of type, stored back to back, to kv keys. Binary extensions must be present. The
+// result is the keys serialized as bytes[]. Use abieos_get_bin_* to retrieve result. Returns false on error, including
+// when a value of type takes no bytes, such as a struct without fields.
+abieos_bool abieos_bin_to_key_batch(abieos_context* context, uint64_t contract, const char* type, const char* data,
+                                    size_t size);
+
+// A column produced by abieos_bin_to_columns. Fixed-size values (integers, floats, names, checksums, assets, ...) are
+// stored width bytes apart in their binary form; varuint32 and varint32 are stored as 4-byte integers. Other values
+// are indexed by offsets: row i is data[offsets[i], offsets[i + 1]). string and bytes columns hold the contents;
+// arrays, variants and recursive structs hold the binary form. Rows where an enclosing optional or binary extension
+// is absent have a clear bit in validity (bit i % 8 of byte i / 8); validity is null if the column can not be null.
+typedef struct abieos_column {
+    const char* name; // field path, e.g. "balance.quantity"
+    const char* type;
+    uint32_t width; // 0 if offsets is used
+    size_t num_rows;
+    const char* data;
+    size_t data_size;
+    const uint32_t* offsets;
+    const uint8_t* validity;
+} abieos_column;
+
+// Decode num_rows binary values of type into one column per leaf field of type; nested structs are flattened. Use
+// abieos_get_column_count and abieos_get_column to retrieve result. Returns false on error.
+abieos_bool abieos_bin_to_columns(abieos_context* context, uint64_t contract, const char* type,
+                                  const char* const* rows, const size_t* sizes, size_t num_rows);
+
+// Number of columns produced by the last abieos_bin_to_columns.
+uint32_t abieos_get_column_count(abieos_context* context);
+
+// Get a column produced by the last abieos_bin_to_columns. The context owns the memory it points to. Returns false on
+// error.
+abieos_bool abieos_get_column(abieos_context* context, uint32_t index, abieos_column* column);
+
+// Limits for abieos_random_bin. Arrays, strings and bytes get up to max_array_size elements or max_string_size bytes;
+// past max_depth nested structs, optionals are absent and arrays are empty.
+typedef struct abieos_random_options {
+    uint32_t max_array_size;
+    uint32_t max_string_size;
+    uint32_t max_depth;
+} abieos_random_options;
+
+// Generate a random valid binary value of type. The same seed always gives the same value. options may be null to use
+// the defaults (4, 32, 8). Use abieos_get_bin_* to retrieve result. Returns false on error.
+abieos_bool abieos_random_bin(abieos_context* context, uint64_t contract, const char* type, uint64_t seed,
+                              const abieos_random_options* options);
+
 // Convert hex to json. The context owns the returned memory. Returns null on error; use abieos_get_error to retrieve
 // error.
 const char* abieos_hex_to_json(abieos_context* context, uint64_t contract, const char* type, const char* hex);
 
+// How json holds bytes values
+typedef enum abieos_bytes_encoding {
+    abieos_bytes_hex,       // the default
+    abieos_bytes_base64,    // RFC 4648, with padding; input may omit it
+    abieos_bytes_base64url, // RFC 4648 url-safe alphabet, without padding; input may have it
+} abieos_bytes_encoding;
+
+// Set how the json of contract values (abieos_json_to_bin, abieos_bin_to_json and the like) holds bytes values.
+// Base64 is a third shorter than hex. Other types, such as checksums, are always hex. Returns false on error.
+abieos_bool abieos_set_bytes_encoding(abieos_context* context, abieos_bytes_encoding encoding);
+
+// The context keeps the buffers which abieos_json_to_bin, abieos_json_to_hex, abieos_bin_to_json,
+// abieos_bin_to_json_stream, abieos_hex_to_json and abieos_json_to_key use, so that repeated calls on similar values
+// don't allocate. After a call, the buffers are released if they hold more than limit bytes (default 1 MiB). A limit
+// of 0 releases them after every call.
+void abieos_set_scratch_limit(abieos_context* context, size_t limit);
+
+// Bytes held by the context's scratch buffers.
+size_t abieos_get_scratch_size(abieos_context* context);
+
+// Limit the work of each conversion, so that a hostile value can't keep the caller busy for long. This covers
+// abieos_json_to_bin, abieos_json_to_bin_reorderable, abieos_json_to_hex, abieos_transaction_json_to_bin, the
+// incremental abieos_json_to_bin_begin/append/finish, abieos_bin_to_json, abieos_bin_to_json_stream,
+// abieos_bin_to_json_parallel, abieos_hex_to_json, abieos_bin_to_document, abieos_transcode_bin, abieos_bin_to_key,
+// abieos_bin_to_key_batch, abieos_json_to_key and abieos_bin_to_columns. max_steps counts the steps of the
+// conversion, about one for each struct field, array element and variant. max_output_size counts bytes of the result:
+// json, binary, document, keys or column data. time_limit_ns is measured on a monotonic clock from the start of the
+// conversion and checked every few hundred steps. An incremental conversion is limited as a whole, from its first
+// append; a batch or set of rows is limited as a whole too. A call which goes over a limit fails with an error saying
+// which. 0 means no limit, which is the default.
+void abieos_set_budget(abieos_context* context, uint64_t max_steps, uint64_t max_output_size, uint64_t time_limit_ns);
+
+// Enable or disable per-type profiling of the conversions listed at abieos_set_budget; abieos_bin_to_json_parallel
+// profiles only the pass which finds its elements. Enabling clears the profile.
+void abieos_set_profiling(abieos_context* context, abieos_bool enable);
+
+// Get the profile as a JSON array of {"contract","type","count","bytes","cycles"}, most cycles first. Time is charged
+// to the innermost struct, array or variant being converted; bytes are binary bytes read or written. The context owns
+// the returned string. Returns null on error; use abieos_get_error to retrieve error.
+const char* abieos_get_profile(abieos_context* context);
+
 // Convert abi json to bin, Use abieos_get_bin_* to retrieve result. Returns false on error.
 abieos_bool abieos_abi_json_to_bin(abieos_context* context, const char* json);
 
@@ -0,0 +1,91 @@
+//
+//  EosioAbieosAbiBinTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+class EosioAbieosAbiBinTests: XCTestCase {
+
+    let bundledAbis = ["transaction.abi.json", "eosio.assert.abi.json"]
+
+    private func bundledAbi(_ fileName: String) throws -> String {
+        let url = URL(fileURLWithPath: #file).deletingLastPathComponent().deletingLastPathComponent().deletingLastPathComponent()
+            .appendingPathComponent("Sources/EosioSwiftAbieosSerializationProvider").appendingPathComponent(fileName)
+        return try String(contentsOf: url, encoding: .utf8)
+    }
+
+    private func abiBin(json: String) -> [CChar] {
+        guard let context = abieos_create() else {
+            return []
+        }
+        defer { abieos_destroy(context) }
+        guard abieos_abi_json_to_bin(context, json) == 1, let data = abieos_get_bin_data(context) else {
+            XCTFail(String(cString: abieos_get_error(context)))
+            return []
+        }
+        return Array(UnsafeBufferPointer(start: data, count: Int(abieos_get_bin_size(context))))
+    }
+
+    /// Loads an abi with load and returns the snapshot of the context, or the error
+    private func loaded(_ load: (OpaquePointer?) -> Bool) -> String {
+        let context = abieos_create()
+        defer { abieos_destroy(context) }
+        guard load(context) else {
+            return "error: " + String(cString: abieos_get_error(context))
+        }
+        guard abieos_save_snapshot(context) == 1, let data = abieos_get_bin_data(context) else {
+            return "error: " + String(cString: abieos_get_error(context))
+        }
+        return Data(bytes: data, count: Int(abieos_get_bin_size(context))).hexEncodedString()
+    }
+
+    /// Loads binary directly
+    private func loadedFromBin(_ bin: ArraySlice<CChar>) -> String {
+        return loaded { context in
+            bin.withUnsafeBufferPointer { abieos_set_abi_bin(context, 1, $0.baseAddress, $0.count) == 1 }
+        }
+    }
+
+    /// Loads binary through an abi_def, by converting it to json first
+    private func loadedFromDef(_ bin: ArraySlice<CChar>) -> String {
+        return loaded { context in
+            guard let json = bin.withUnsafeBufferPointer({ abieos_abi_bin_to_json(context, $0.baseAddress, $0.count) }) else {
+                return false
+            }
+            return abieos_set_abi(context, 1, String(cString: json)) == 1
+        }
+    }
+
+    func testJsonAndBinaryGiveTheSameAbi() throws {
+        for fileName in bundledAbis {
+            let json = try bundledAbi(fileName)
+            let bin = abiBin(json: json)
+            let fromJson = loaded { abieos_set_abi($0, 1, json) == 1 }
+            XCTAssertFalse(fromJson.hasPrefix("error"), fileName)
+            XCTAssertEqual(loadedFromBin(bin[...]), fromJson, fileName)
+        }
+    }
+
+    func testTruncatedAbis() throws {
+        for fileName in bundledAbis {
+            let bin = abiBin(json: try bundledAbi(fileName))
+            var loads = 0
+            for size in 0...bin.count {
+                let fromBin = loadedFromBin(bin[0..<size])
+                XCTAssertEqual(fromBin, loadedFromDef(bin[0..<size]), "\(fileName) truncated to \(size) bytes")
+                loads += fromBin.hasPrefix("error") ? 0 : 1
+            }
+            // The whole abi, and prefixes which only lack trailing binary extensions
+            XCTAssertGreaterThan(loads, 1, fileName)
+        }
+    }
+
+}
@@ -0,0 +1,76 @@
+//
+//  EosioAbieosAssetTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+// swiftlint:disable line_length
+import Foundation
+import XCTest
+import EosioSwiftAbieosSerializationProvider
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+class EosioAbieosAssetTests: XCTestCase {
+
+    let abieos = EosioAbieosSerializationProvider()
+
+    let holdingAbi = """
+    {"version":"eosio::abi/1.1","structs":[{"name":"holding","base":"","fields":[{"name":"quantity","type":"asset"},{"name":"sym","type":"symbol"}]}]}
+    """
+
+    private func holding(_ quantity: String, _ sym: String) -> String {
+        return "{\"quantity\":\"\(quantity)\",\"sym\":\"\(sym)\"}"
+    }
+
+    private func assertRoundTrip(_ quantity: String, _ sym: String, hex expectedHex: String, file: StaticString = #file, line: UInt = #line) {
+        let json = holding(quantity, sym)
+        do {
+            let hex = try abieos.serialize(contract: "test", type: "holding", json: json, abi: holdingAbi)
+            XCTAssertEqual(hex, expectedHex, file: file, line: line)
+            let result = try abieos.deserialize(contract: "test", type: "holding", hex: hex, abi: holdingAbi)
+            XCTAssertEqual(result, json, file: file, line: line)
+        } catch {
+            XCTFail("Failed to round trip \(json): \(error)", file: file, line: line)
+        }
+    }
+
+    private func assertRejected(_ quantity: String, _ sym: String, file: StaticString = #file, line: UInt = #line) {
+        let json = holding(quantity, sym)
+        XCTAssertThrowsError(try abieos.serialize(contract: "test", type: "holding", json: json, abi: holdingAbi), "\(json) should not serialize", file: file, line: line)
+    }
+
+    func testAssetInt64Bounds() {
+        assertRoundTrip("922337203685477.5807 EOS", "4,EOS", hex: "FFFFFFFFFFFFFF7F04454F530000000004454F5300000000")
+        assertRoundTrip("-922337203685477.5808 EOS", "4,EOS", hex: "000000000000008004454F530000000004454F5300000000")
+        assertRoundTrip("9223372036854775807 MAX", "0,MAX", hex: "FFFFFFFFFFFFFF7F004D415800000000004D415800000000")
+        assertRoundTrip("-9223372036854775808 MIN", "0,MIN", hex: "0000000000000080004D494E00000000004D494E00000000")
+    }
+
+    func testAssetOverflowByOne() {
+        assertRejected("922337203685477.5808 EOS", "4,EOS")
+        assertRejected("-922337203685477.5809 EOS", "4,EOS")
+        assertRejected("9223372036854775808 MAX", "0,MAX")
+    }
+
+    func testPrecisionBounds() {
+        let tiny = "0." + String(repeating: "0", count: 254) + "1 TINY"
+        assertRoundTrip(tiny, "255,TINY", hex: "0100000000000000FF54494E59000000FF54494E59000000")
+        assertRoundTrip("1.0000 EOS", "255,EOS", hex: "102700000000000004454F5300000000FF454F5300000000")
+
+        let tooPrecise = "0." + String(repeating: "0", count: 255) + "1 TINY"
+        assertRejected(tooPrecise, "255,TINY")
+        assertRejected("1.0000 EOS", "256,EOS")
+    }
+
+    func testAssetAndSymbolFormatting() {
+        assertRoundTrip("0.0001 EOS", "0,A", hex: "010000000000000004454F53000000000041000000000000")
+        assertRoundTrip("-0.0500 EOS", "18,ABCDEFG", hex: "0CFEFFFFFFFFFFFF04454F53000000001241424344454647")
+        assertRoundTrip("1 EOS", "4,EOS", hex: "010000000000000000454F530000000004454F5300000000")
+        assertRoundTrip("100.000000 USD", "6,USD", hex: "00E1F5050000000006555344000000000655534400000000")
+    }
+
+}
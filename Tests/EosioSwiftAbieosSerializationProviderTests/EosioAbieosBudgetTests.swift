@@ -0,0 +1,198 @@
+//
+//  EosioAbieosBudgetTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+// swiftlint:disable line_length
+import Foundation
+import XCTest
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+class EosioAbieosBudgetTests: XCTestCase {
+
+    let abi = """
+    {"version":"eosio::abi/1.1","structs":[{"name":"point","base":"","fields":[{"name":"x","type":"uint32"},{"name":"y","type":"uint32"}]},{"name":"list","base":"","fields":[{"name":"items","type":"point[]"}]}]}
+    """
+
+    /// point with a new optional field, for abieos_transcode_bin
+    let newAbi = """
+    {"version":"eosio::abi/1.1","structs":[{"name":"point","base":"","fields":[{"name":"x","type":"uint32"},{"name":"y","type":"uint32"},{"name":"z","type":"uint8?"}]},{"name":"list","base":"","fields":[{"name":"items","type":"point[]"}]}]}
+    """
+
+    let point = """
+    {"x":1,"y":2}
+    """
+
+    /// A list of 100 points, which takes a few hundred steps to convert
+    let list = "{\"items\":[" + (0..<100).map { "{\"x\":\($0),\"y\":\(2 * $0)}" }.joined(separator: ",") + "]}"
+
+    let smallBudget: UInt64 = 10
+
+    var context: OpaquePointer?
+    var listBin = [CChar]()
+    var pointBin = [CChar]()
+
+    override func setUp() {
+        super.setUp()
+        context = abieos_create()
+        XCTAssertEqual(abieos_set_abi(context, 1, abi), 1)
+        XCTAssertEqual(abieos_set_abi(context, 2, newAbi), 1)
+        listBin = bin(type: "list", json: list)
+        pointBin = bin(type: "point", json: point)
+    }
+
+    override func tearDown() {
+        abieos_destroy(context)
+        context = nil
+        super.tearDown()
+    }
+
+    private var error: String {
+        return String(cString: abieos_get_error(context))
+    }
+
+    private func bin(type: String, json: String) -> [CChar] {
+        guard abieos_json_to_bin(context, 1, type, json) == 1, let data = abieos_get_bin_data(context) else {
+            XCTFail(error)
+            return []
+        }
+        return Array(UnsafeBufferPointer(start: data, count: Int(abieos_get_bin_size(context))))
+    }
+
+    /// Checks that convert succeeds without a budget and fails with a small step budget
+    private func assertStopped(_ convert: () -> Bool, maxSteps: UInt64? = nil, file: StaticString = #file, line: UInt = #line) {
+        abieos_set_budget(context, 0, 0, 0)
+        XCTAssertTrue(convert(), "without a budget: \(error)", file: file, line: line)
+        abieos_set_budget(context, maxSteps ?? smallBudget, 0, 0)
+        XCTAssertFalse(convert(), "with a budget", file: file, line: line)
+        XCTAssertEqual(error, "Step limit exceeded", file: file, line: line)
+    }
+
+    func testJsonToBin() {
+        assertStopped { abieos_json_to_bin(context, 1, "list", list) == 1 }
+    }
+
+    func testJsonToBinReorderable() {
+        assertStopped { abieos_json_to_bin_reorderable(context, 1, "list", list) == 1 }
+    }
+
+    func testJsonToHex() {
+        assertStopped { abieos_json_to_hex(context, 1, "list", list) != nil }
+    }
+
+    func testTransactionJsonToBin() {
+        let chainId = [CChar](repeating: 0, count: 32)
+        var digest = [CChar](repeating: 0, count: 32)
+        assertStopped { abieos_transaction_json_to_bin(context, 1, "list", list, chainId, nil, 0, &digest) == 1 }
+    }
+
+    func testIncrementalJsonToBin() {
+        assertStopped {
+            guard abieos_json_to_bin_begin(context, 1, "list") == 1 else {
+                return false
+            }
+            let bytes = Array(list.utf8CString.dropLast())
+            return bytes.withUnsafeBufferPointer { buffer in
+                abieos_json_to_bin_append(context, buffer.baseAddress, buffer.count) == 1 && abieos_json_to_bin_finish(context) == 1
+            }
+        }
+    }
+
+    func testBinToJson() {
+        assertStopped { abieos_bin_to_json(context, 1, "list", listBin, listBin.count) != nil }
+    }
+
+    func testBinToJsonStream() {
+        assertStopped { abieos_bin_to_json_stream(context, 1, "list", listBin, listBin.count, 0, { _, _, _ in 1 }, nil) == 1 }
+    }
+
+    func testBinToJsonParallel() {
+        assertStopped { abieos_bin_to_json_parallel(context, 1, "list", listBin, listBin.count, 4) != nil }
+    }
+
+    func testBinToJsonParallelOnThreads() {
+        // Large enough to be split between threads
+        let large = bin(type: "list", json: "{\"items\":[" + Array(repeating: point, count: 20000).joined(separator: ",") + "]}")
+        assertStopped({ abieos_bin_to_json_parallel(context, 1, "list", large, large.count, 4) != nil }, maxSteps: 80000)
+    }
+
+    func testHexToJson() {
+        let hex = (listBin.map { String(format: "%02X", UInt8(bitPattern: $0)) }).joined()
+        assertStopped { abieos_hex_to_json(context, 1, "list", hex) != nil }
+    }
+
+    func testBinToDocument() {
+        assertStopped { abieos_bin_to_document(context, 1, "list", listBin, listBin.count, abieos_document_cbor) == 1 }
+    }
+
+    func testTranscodeBin() {
+        assertStopped { abieos_transcode_bin(context, 1, "list", 2, "list", listBin, listBin.count) == 1 }
+    }
+
+    func testBinToKey() {
+        assertStopped({ abieos_bin_to_key(context, 1, "point", pointBin, pointBin.count) == 1 }, maxSteps: 2)
+    }
+
+    func testJsonToKey() {
+        assertStopped({ abieos_json_to_key(context, 1, "point", point) == 1 }, maxSteps: 6)
+    }
+
+    func testBinToKeyBatchSharesBudget() {
+        let points = Array([[CChar]](repeating: pointBin, count: 10).joined())
+        // Enough for one point but not for ten
+        abieos_set_budget(context, smallBudget, 0, 0)
+        XCTAssertEqual(abieos_bin_to_key_batch(context, 1, "point", pointBin, pointBin.count), 1)
+        assertStopped { abieos_bin_to_key_batch(context, 1, "point", points, points.count) == 1 }
+    }
+
+    func testBinToColumnsSharesBudget() {
+        pointBin.withUnsafeBufferPointer { buffer in
+            let rows = [UnsafePointer<CChar>?](repeating: buffer.baseAddress, count: 10)
+            let sizes = [Int](repeating: buffer.count, count: 10)
+            // Enough for one row but not for ten
+            abieos_set_budget(context, smallBudget, 0, 0)
+            XCTAssertEqual(abieos_bin_to_columns(context, 1, "point", rows, sizes, 1), 1)
+            assertStopped { abieos_bin_to_columns(context, 1, "point", rows, sizes, 10) == 1 }
+        }
+    }
+
+    func testIncrementalJsonToBinSharesBudget() {
+        // Each append takes fewer than 200 steps; all of them take more
+        abieos_set_budget(context, 200, 0, 0)
+        XCTAssertEqual(abieos_json_to_bin_begin(context, 1, "list"), 1)
+        let bytes = Array(list.utf8CString.dropLast())
+        var ok = true
+        var appends = 0
+        for start in stride(from: 0, to: bytes.count, by: 100) where ok {
+            ok = bytes[start..<min(start + 100, bytes.count)].withUnsafeBufferPointer { abieos_json_to_bin_append(context, $0.baseAddress, $0.count) } == 1
+            appends += ok ? 1 : 0
+        }
+        if ok {
+            ok = abieos_json_to_bin_finish(context) == 1
+        }
+        XCTAssertFalse(ok)
+        XCTAssertGreaterThan(appends, 1)
+        XCTAssertEqual(error, "Step limit exceeded")
+    }
+
+    func testOutputLimit() {
+        abieos_set_budget(context, 0, 100, 0)
+        XCTAssertNil(abieos_bin_to_json(context, 1, "list", listBin, listBin.count))
+        XCTAssertEqual(error, "Output size limit exceeded")
+        XCTAssertNotNil(abieos_bin_to_json(context, 1, "point", pointBin, pointBin.count))
+    }
+
+    func testTimeLimit() {
+        abieos_set_budget(context, 0, 0, 1)
+        XCTAssertNil(abieos_bin_to_json(context, 1, "list", listBin, listBin.count))
+        XCTAssertEqual(error, "Time limit exceeded")
+        // The clock is only read every few hundred steps
+        XCTAssertNotNil(abieos_bin_to_json(context, 1, "point", pointBin, pointBin.count))
+    }
+
+}
@@ -0,0 +1,91 @@
+//
+//  EosioAbieosBytesEncodingTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+// swiftlint:disable line_length
+import Foundation
+import XCTest
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+class EosioAbieosBytesEncodingTests: XCTestCase {
+
+    let blobAbi = """
+    {"version":"eosio::abi/1.1","structs":[{"name":"blob","base":"","fields":[{"name":"b","type":"bytes"}]}]}
+    """
+
+    var context: OpaquePointer?
+
+    override func setUp() {
+        super.setUp()
+        context = abieos_create()
+        XCTAssertEqual(abieos_set_abi(context, 0, blobAbi), 1)
+    }
+
+    override func tearDown() {
+        abieos_destroy(context)
+        context = nil
+        super.tearDown()
+    }
+
+    private func assertAccepted(_ encoded: String, hex expectedHex: String, back expectedBack: String? = nil, file: StaticString = #file, line: UInt = #line) {
+        let json = "{\"b\":\"\(encoded)\"}"
+        guard abieos_json_to_bin(context, 0, "blob", json) == 1 else {
+            XCTFail("\(json) was rejected: \(String(cString: abieos_get_error(context)))", file: file, line: line)
+            return
+        }
+        let hex = String(cString: abieos_get_bin_hex(context))
+        XCTAssertEqual(hex, expectedHex, file: file, line: line)
+        guard let back = abieos_hex_to_json(context, 0, "blob", hex) else {
+            XCTFail("Unable to convert \(hex) back: \(String(cString: abieos_get_error(context)))", file: file, line: line)
+            return
+        }
+        XCTAssertEqual(String(cString: back), "{\"b\":\"\(expectedBack ?? encoded)\"}", file: file, line: line)
+    }
+
+    private func assertRejected(_ encoded: String, error expectedError: String, file: StaticString = #file, line: UInt = #line) {
+        let json = "{\"b\":\"\(encoded)\"}"
+        XCTAssertEqual(abieos_json_to_bin(context, 0, "blob", json), 0, "\(json) should be rejected", file: file, line: line)
+        XCTAssertTrue(String(cString: abieos_get_error(context)).contains(expectedError), file: file, line: line)
+    }
+
+    func testHex() {
+        XCTAssertEqual(abieos_set_bytes_encoding(context, abieos_bytes_hex), 1)
+        assertAccepted("00ff10", hex: "0300FF10", back: "00FF10")
+        assertRejected("AP8=", error: "Expected string containing hex")
+    }
+
+    func testBase64() {
+        XCTAssertEqual(abieos_set_bytes_encoding(context, abieos_bytes_base64), 1)
+        assertAccepted("AP8Q", hex: "0300FF10")
+        assertAccepted("AP8=", hex: "0200FF")
+        assertAccepted("AP8", hex: "0200FF", back: "AP8=")
+        assertAccepted("AA==", hex: "0100")
+        assertAccepted("QUJD", hex: "03414243")
+        assertAccepted("QUI=", hex: "024142")
+    }
+
+    func testBase64RejectsBadPaddingAndTrailingBits() {
+        XCTAssertEqual(abieos_set_bytes_encoding(context, abieos_bytes_base64), 1)
+        for encoded in ["AP9=", "AB==", "QQ=", "AP-Q", "_w", "00ff10"] {
+            assertRejected(encoded, error: "Expected string containing base64")
+        }
+    }
+
+    func testBase64Url() {
+        XCTAssertEqual(abieos_set_bytes_encoding(context, abieos_bytes_base64url), 1)
+        assertAccepted("AP-Q", hex: "0300FF90")
+        assertAccepted("_w", hex: "01FF")
+        assertAccepted("_w==", hex: "01FF", back: "_w")
+        assertAccepted("AP8=", hex: "0200FF", back: "AP8")
+        for encoded in ["AP9=", "AB==", "QQ="] {
+            assertRejected(encoded, error: "Expected string containing base64")
+        }
+    }
+
+}
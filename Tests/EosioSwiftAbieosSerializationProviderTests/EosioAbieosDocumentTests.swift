@@ -0,0 +1,278 @@
+//
+//  EosioAbieosDocumentTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+// swiftlint:disable line_length
+import Foundation
+import XCTest
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+/// A decoded cbor or msgpack value, limited to what the tests produce
+private enum DocumentValue: Equatable {
+    case uint(UInt64)
+    case string(String)
+    case array([DocumentValue])
+    case map([DocumentEntry])
+}
+
+private struct DocumentEntry: Equatable {
+    let key: String
+    let value: DocumentValue
+}
+
+private struct DocumentReader {
+    let bytes: [UInt8]
+    var pos = 0
+
+    init(_ bytes: [UInt8]) {
+        self.bytes = bytes
+    }
+
+    mutating func byte() -> UInt8? {
+        guard pos < bytes.count else {
+            return nil
+        }
+        pos += 1
+        return bytes[pos - 1]
+    }
+
+    /// Big-endian unsigned integer of size bytes
+    mutating func uint(_ size: Int) -> UInt64? {
+        var result: UInt64 = 0
+        for _ in 0..<size {
+            guard let b = byte() else {
+                return nil
+            }
+            result = result << 8 | UInt64(b)
+        }
+        return result
+    }
+
+    mutating func string(_ size: UInt64) -> String? {
+        guard size <= UInt64(bytes.count - pos) else {
+            return nil
+        }
+        pos += Int(size)
+        return String(decoding: bytes[pos - Int(size)..<pos], as: UTF8.self)
+    }
+}
+
+class EosioAbieosDocumentTests: XCTestCase {
+
+    let formats = [abieos_document_cbor, abieos_document_msgpack]
+
+    var context: OpaquePointer?
+    var nextContract: UInt64 = 1
+
+    override func setUp() {
+        super.setUp()
+        context = abieos_create()
+    }
+
+    override func tearDown() {
+        abieos_destroy(context)
+        context = nil
+        super.tearDown()
+    }
+
+    private var error: String {
+        return "error: " + String(cString: abieos_get_error(context))
+    }
+
+    private func setAbi(structs: String) -> UInt64 {
+        let contract = nextContract
+        nextContract += 1
+        XCTAssertEqual(abieos_set_abi(context, contract, "{\"version\":\"eosio::abi/1.1\",\"structs\":\(structs)}"), 1, error)
+        return contract
+    }
+
+    private func document(contract: UInt64, type: String, bin: [UInt8], format: abieos_document_format) -> [UInt8] {
+        let ok = bin.withUnsafeBufferPointer { buffer in
+            buffer.withMemoryRebound(to: CChar.self) { abieos_bin_to_document(context, contract, type, $0.baseAddress, $0.count, format) }
+        }
+        guard ok == 1, let data = abieos_get_bin_data(context) else {
+            XCTFail(error)
+            return []
+        }
+        return UnsafeBufferPointer(start: data, count: Int(abieos_get_bin_size(context))).map { UInt8(bitPattern: $0) }
+    }
+
+    private func hex(_ bytes: ArraySlice<UInt8>) -> String {
+        return bytes.map { String(format: "%02X", $0) }.joined()
+    }
+
+    /// Decodes all of bytes, or returns nil
+    private func decode(_ bytes: [UInt8], format: abieos_document_format) -> DocumentValue? {
+        var reader = DocumentReader(bytes)
+        let value = format == abieos_document_cbor ? decodeCbor(&reader) : decodeMsgpack(&reader)
+        return reader.pos == bytes.count ? value : nil
+    }
+
+    private func decodeCbor(_ reader: inout DocumentReader) -> DocumentValue? {
+        guard let head = reader.byte() else {
+            return nil
+        }
+        let info = head & 0x1f
+        var argument = UInt64(info)
+        if info >= 24 {
+            guard info <= 27, let value = reader.uint(1 << Int(info - 24)) else {
+                return nil
+            }
+            argument = value
+        }
+        switch head >> 5 {
+        case 0:
+            return .uint(argument)
+        case 3:
+            return reader.string(argument).map { .string($0) }
+        case 4:
+            return decodeItems(argument, &reader, decodeCbor).map { .array($0) }
+        case 5:
+            return decodeEntries(argument, &reader, decodeCbor).map { .map($0) }
+        default:
+            return nil
+        }
+    }
+
+    private func decodeMsgpack(_ reader: inout DocumentReader) -> DocumentValue? {
+        guard let head = reader.byte() else {
+            return nil
+        }
+        switch head {
+        case 0x00...0x7f:
+            return .uint(UInt64(head))
+        case 0x80...0x8f:
+            return decodeEntries(UInt64(head & 0x0f), &reader, decodeMsgpack).map { .map($0) }
+        case 0x90...0x9f:
+            return decodeItems(UInt64(head & 0x0f), &reader, decodeMsgpack).map { .array($0) }
+        case 0xa0...0xbf:
+            return reader.string(UInt64(head & 0x1f)).map { .string($0) }
+        case 0xcc...0xcf:
+            return reader.uint(1 << Int(head - 0xcc)).map { .uint($0) }
+        case 0xd9...0xdb:
+            return reader.uint(1 << Int(head - 0xd9)).flatMap { reader.string($0) }.map { .string($0) }
+        case 0xdc, 0xdd:
+            return reader.uint(head == 0xdc ? 2 : 4).flatMap { decodeItems($0, &reader, decodeMsgpack) }.map { .array($0) }
+        case 0xde, 0xdf:
+            return reader.uint(head == 0xde ? 2 : 4).flatMap { decodeEntries($0, &reader, decodeMsgpack) }.map { .map($0) }
+        default:
+            return nil
+        }
+    }
+
+    private func decodeItems(_ count: UInt64, _ reader: inout DocumentReader, _ decodeValue: (inout DocumentReader) -> DocumentValue?) -> [DocumentValue]? {
+        var items = [DocumentValue]()
+        for _ in 0..<count {
+            guard let item = decodeValue(&reader) else {
+                return nil
+            }
+            items.append(item)
+        }
+        return items
+    }
+
+    private func decodeEntries(_ count: UInt64, _ reader: inout DocumentReader, _ decodeValue: (inout DocumentReader) -> DocumentValue?) -> [DocumentEntry]? {
+        var entries = [DocumentEntry]()
+        for _ in 0..<count {
+            guard case .string(let key)? = decodeValue(&reader), let value = decodeValue(&reader) else {
+                return nil
+            }
+            entries.append(DocumentEntry(key: key, value: value))
+        }
+        return entries
+    }
+
+    func testStructWithAbsentExtensions() {
+        let contract = setAbi(structs: """
+        [{"name":"s","base":"","fields":[{"name":"a","type":"uint8"},{"name":"s","type":"string"},{"name":"v","type":"uint16[]"},{"name":"e","type":"uint32$"},{"name":"f","type":"string$"}]}]
+        """)
+        let bin: [UInt8] = [0x01, 0x02, 0x68, 0x69, 0x02, 0x2c, 0x01, 0x02, 0x00, 0x70, 0x11, 0x01, 0x00, 0x01, 0x78]
+        let entries = [DocumentEntry(key: "a", value: .uint(1)), DocumentEntry(key: "s", value: .string("hi")), DocumentEntry(key: "v", value: .array([.uint(300), .uint(2)])),
+                       DocumentEntry(key: "e", value: .uint(70000)), DocumentEntry(key: "f", value: .string("x"))]
+        let expected: [(size: Int, cbor: String, msgpack: String)] = [
+            (9, "A3616101617362686961768219012C02", "83A16101A173A26869A17692CD012C02"),
+            (13, "A4616101617362686961768219012C0261651A00011170", "84A16101A173A26869A17692CD012C02A165CE00011170"),
+            (15, "A5616101617362686961768219012C0261651A0001117061666178", "85A16101A173A26869A17692CD012C02A165CE00011170A166A178"),
+        ]
+        for (present, (size, cbor, msgpack)) in zip([3, 4, 5], expected) {
+            for (format, expectedHex) in zip(formats, [cbor, msgpack]) {
+                let doc = document(contract: contract, type: "s", bin: Array(bin.prefix(size)), format: format)
+                XCTAssertEqual(hex(doc[...]), expectedHex)
+                XCTAssertEqual(decode(doc, format: format), .map(Array(entries.prefix(present))), "\(present) fields, format \(format)")
+            }
+        }
+    }
+
+    func testArrayHeaders() {
+        let contract = setAbi(structs: """
+        [{"name":"s","base":"","fields":[{"name":"v","type":"uint8[]"}]}]
+        """)
+        let headers: [(count: Int, cbor: String, msgpack: String)] = [
+            (0, "80", "90"),
+            (15, "8F", "9F"),
+            (16, "90", "DC0010"),
+            (23, "97", "DC0017"),
+            (24, "9818", "DC0018"),
+            (255, "98FF", "DC00FF"),
+            (256, "990100", "DC0100"),
+            (65535, "99FFFF", "DCFFFF"),
+            (65536, "9A00010000", "DD00010000"),
+        ]
+        for (count, cbor, msgpack) in headers {
+            var bin = [UInt8]()
+            var size = count
+            repeat {
+                bin.append(UInt8(size & 0x7f) | (size > 0x7f ? 0x80 : 0))
+                size >>= 7
+            } while size > 0
+            bin += (0..<count).map { UInt8($0 & 0xff) }
+            let expected = DocumentValue.map([DocumentEntry(key: "v", value: .array((0..<count).map { .uint(UInt64($0 & 0xff)) }))])
+            // The struct's map and field name come before the array
+            for (format, prefix) in zip(formats, ["A16176" + cbor, "81A176" + msgpack]) {
+                let doc = document(contract: contract, type: "s", bin: bin, format: format)
+                XCTAssertEqual(hex(doc.prefix(prefix.count / 2)), prefix, "\(count) items")
+                XCTAssertEqual(decode(doc, format: format), expected, "\(count) items, format \(format)")
+            }
+        }
+    }
+
+    func testMapHeaders() {
+        // Structs of uint8 fields with two trailing extensions. The header is sized for every field, then patched
+        // with the number of fields present.
+        let headers: [(fields: Int, extensions: Int, cbor: String, msgpack: String)] = [
+            (13, 0, "AD", "8D"),
+            (14, 0, "AE", "DE000E"),
+            (14, 2, "B0", "DE0010"),
+            (21, 0, "B5", "DE0015"),
+            (22, 0, "B816", "DE0016"),
+            (22, 2, "B818", "DE0018"),
+            (254, 0, "B900FE", "DE00FE"),
+            (254, 2, "B90100", "DE0100"),
+            (65533, 0, "B9FFFD", "DEFFFD"),
+            (65534, 0, "BA0000FFFE", "DF0000FFFE"),
+            (65534, 2, "BA00010000", "DF00010000"),
+        ]
+        var contracts = [Int: UInt64]()
+        for (fields, extensions, cbor, msgpack) in headers {
+            let names = (0..<fields).map { "f\($0)" } + ["e0", "e1"]
+            if contracts[fields] == nil {
+                let types = (0..<fields).map { _ in "uint8" } + ["uint8$", "uint8$"]
+                contracts[fields] = setAbi(structs: "[{\"name\":\"s\",\"base\":\"\",\"fields\":[" + zip(names, types).map { "{\"name\":\"\($0.0)\",\"type\":\"\($0.1)\"}" }.joined(separator: ",") + "]}]")
+            }
+            let bin = (0..<fields + extensions).map { UInt8($0 & 0xff) }
+            let expected = DocumentValue.map(bin.enumerated().map { DocumentEntry(key: names[$0.offset], value: .uint(UInt64($0.element))) })
+            for (format, header) in zip(formats, [cbor, msgpack]) {
+                let doc = document(contract: contracts[fields] ?? 0, type: "s", bin: bin, format: format)
+                XCTAssertEqual(hex(doc.prefix(header.count / 2)), header, "\(fields) fields, \(extensions) extensions")
+                XCTAssertEqual(decode(doc, format: format), expected, "\(fields) fields, \(extensions) extensions, format \(format)")
+            }
+        }
+    }
+
+}
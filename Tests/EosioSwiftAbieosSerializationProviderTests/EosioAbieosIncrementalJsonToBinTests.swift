@@ -0,0 +1,190 @@
+//
+//  EosioAbieosIncrementalJsonToBinTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+// swiftlint:disable line_length
+import Foundation
+import XCTest
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+class EosioAbieosIncrementalJsonToBinTests: XCTestCase {
+
+    let abi = """
+    {"version":"eosio::abi/1.1","types":[{"new_type_name":"id","type":"uint64"}],"structs":[{"name":"point","base":"","fields":[{"name":"x","type":"int32"},{"name":"y","type":"float64"}]},{"name":"record","base":"","fields":[{"name":"id","type":"id"},{"name":"owner","type":"name"},{"name":"memo","type":"string"},{"name":"points","type":"point[]"},{"name":"maybe","type":"uint8?"},{"name":"none","type":"uint8?"},{"name":"choice","type":"choice"},{"name":"data","type":"bytes"},{"name":"flag","type":"bool"},{"name":"balance","type":"asset"},{"name":"when","type":"time_point"},{"name":"ext","type":"string$"}]}],"variants":[{"name":"choice","types":["uint16","point"]}]}
+    """
+
+    let compact = #"""
+    {"id":"18446744073709551615","owner":"cryptkeeper","memo":"quote \" backslash \\ tab \t escaped \u00e9\ud83d\ude00 \/ raw é 日本 😀","points":[{"x":-1,"y":1.5},{"x":2147483647,"y":-0.25e3}],"maybe":7,"none":null,"choice":["point",{"x":3,"y":0}],"data":"00ff10","flag":true,"balance":"1.0000 EOS","when":"2019-02-26T18:31:50.000","ext":"end"}
+    """#
+
+    let pretty = #"""
+    {
+        "id": "18446744073709551615",
+        "owner": "cryptkeeper",
+        "memo": "quote \" backslash \\ tab \t escaped \u00e9\ud83d\ude00 \/ raw é 日本 😀",
+        "points": [
+            {
+                "x": -1,
+                "y": 1.5
+            },
+            {
+                "x": 2147483647,
+                "y": -0.25e3
+            }
+        ],
+        "maybe": 7,
+        "none": null,
+        "choice": [
+            "point",
+            {
+                "x": 3,
+                "y": 0
+            }
+        ],
+        "data": "00ff10",
+        "flag": true,
+        "balance": "1.0000 EOS",
+        "when": "2019-02-26T18:31:50.000",
+        "ext": "end"
+    }
+
+    """#
+
+    /// Larger than the 4096 byte chunks
+    var large: String {
+        let points = (0..<500).map { "{\"x\":\($0 * 7919 - 1000000),\"y\":\($0).125}" }.joined(separator: ",")
+        return "{\"id\":1,\"owner\":\"eosio\",\"memo\":\"\",\"points\":[\(points)],\"maybe\":null,\"none\":null,\"choice\":[\"uint16\",65535],\"data\":\"\",\"flag\":false,\"balance\":\"-0.0001 EOS\",\"when\":\"1970-01-01T00:00:00.000\"}"
+    }
+
+    var context: OpaquePointer?
+
+    override func setUp() {
+        super.setUp()
+        context = abieos_create()
+        XCTAssertEqual(abieos_set_abi(context, 1, abi), 1)
+    }
+
+    override func tearDown() {
+        abieos_destroy(context)
+        context = nil
+        super.tearDown()
+    }
+
+    private var result: String {
+        return String(cString: abieos_get_bin_hex(context))
+    }
+
+    private var error: String {
+        return "error: " + String(cString: abieos_get_error(context))
+    }
+
+    private func append(_ chunk: ArraySlice<UInt8>) -> abieos_bool {
+        return chunk.withUnsafeBufferPointer { buffer in
+            buffer.withMemoryRebound(to: CChar.self) { abieos_json_to_bin_append(context, $0.baseAddress, $0.count) }
+        }
+    }
+
+    /// The hex result of abieos_json_to_bin, or its error
+    private func whole(_ json: String, type: String) -> String {
+        return abieos_json_to_bin(context, 1, type, json) == 1 ? result : error
+    }
+
+    /// The hex result of the incremental conversion with chunks of nextSize() bytes, or its error
+    private func chunked(_ json: String, type: String, nextSize: () -> Int) -> String {
+        guard abieos_json_to_bin_begin(context, 1, type) == 1 else {
+            return error
+        }
+        let bytes = Array(json.utf8)
+        var pos = 0
+        while pos < bytes.count {
+            let end = min(pos + nextSize(), bytes.count)
+            guard append(bytes[pos..<end]) == 1 else {
+                return error
+            }
+            pos = end
+        }
+        return abieos_json_to_bin_finish(context) == 1 ? result : error
+    }
+
+    private func assertSameAsWhole(_ json: String, type: String = "record", file: StaticString = #file, line: UInt = #line) {
+        let expected = whole(json, type: type)
+        for size in [1, 3, 4096] {
+            XCTAssertEqual(chunked(json, type: type, nextSize: { size }), expected, "chunks of \(size)", file: file, line: line)
+        }
+        var seed: UInt64 = 1
+        let random = chunked(json, type: type, nextSize: {
+            seed = seed &* 6364136223846793005 &+ 1442695040888963407
+            return Int((seed >> 33) % 64) + 1
+        })
+        XCTAssertEqual(random, expected, "random chunks", file: file, line: line)
+    }
+
+    func testCompact() {
+        XCTAssertEqual(whole(compact, type: "record").prefix(16), "FFFFFFFFFFFFFFFF")
+        assertSameAsWhole(compact)
+    }
+
+    func testPretty() {
+        XCTAssertEqual(whole(pretty, type: "record"), whole(compact, type: "record"))
+        assertSameAsWhole(pretty)
+    }
+
+    func testLarge() {
+        XCTAssertGreaterThan(large.utf8.count, 4096)
+        assertSameAsWhole(large)
+    }
+
+    func testErrors() {
+        assertSameAsWhole("")
+        assertSameAsWhole("{\"x\":1,", type: "point")
+        assertSameAsWhole("{\"x\":1,\"y\":2}{", type: "point")
+        assertSameAsWhole("{\"x\":\"q\",\"y\":2}", type: "point")
+        assertSameAsWhole("{\"y\":2,\"x\":1}", type: "point")
+    }
+
+    func testAppendOrFinishWithoutBegin() {
+        XCTAssertEqual(append(ArraySlice("{".utf8)), 0)
+        XCTAssertEqual(error, "error: abieos_json_to_bin_begin was not called")
+        XCTAssertEqual(abieos_json_to_bin_finish(context), 0)
+        XCTAssertEqual(error, "error: abieos_json_to_bin_begin was not called")
+    }
+
+    func testFinishEndsTheConversion() {
+        XCTAssertEqual(chunked("{\"x\":1,\"y\":2}", type: "point", nextSize: { 5 }), "010000000000000000000040")
+        XCTAssertEqual(abieos_json_to_bin_finish(context), 0)
+        XCTAssertEqual(error, "error: abieos_json_to_bin_begin was not called")
+    }
+
+    func testErrorEndsTheConversion() {
+        XCTAssertEqual(abieos_json_to_bin_begin(context, 1, "point"), 1)
+        XCTAssertEqual(append(ArraySlice("{\"x\":\"q\",\"y\":2}".utf8)), 0)
+        XCTAssertEqual(error, "error: Expected integer")
+        XCTAssertEqual(append(ArraySlice("}".utf8)), 0)
+        XCTAssertEqual(error, "error: abieos_json_to_bin_begin was not called")
+    }
+
+    func testBeginDiscardsPendingConversion() {
+        XCTAssertEqual(abieos_json_to_bin_begin(context, 1, "record"), 1)
+        XCTAssertEqual(append(ArraySlice("{\"id\":1,\"owner\":\"eo".utf8)), 1)
+        XCTAssertEqual(abieos_json_to_bin_begin(context, 1, "point"), 1)
+        XCTAssertEqual(append(ArraySlice("{\"x\":1,\"y\":2}".utf8)), 1)
+        XCTAssertEqual(abieos_json_to_bin_finish(context), 1)
+        XCTAssertEqual(result, "010000000000000000000040")
+    }
+
+    func testBeginErrors() {
+        XCTAssertEqual(abieos_json_to_bin_begin(context, 2, "point"), 0)
+        XCTAssertEqual(error, "error: contract \"............2\" is not loaded")
+        XCTAssertEqual(abieos_json_to_bin_begin(context, 1, "nothing"), 0)
+        XCTAssertEqual(error, "error: Unknown type")
+        XCTAssertEqual(append(ArraySlice("{".utf8)), 0)
+        XCTAssertEqual(error, "error: abieos_json_to_bin_begin was not called")
+    }
+
+}
@@ -0,0 +1,63 @@
+//
+//  EosioAbieosKeyBatchTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+// swiftlint:disable line_length
+import Foundation
+import XCTest
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+class EosioAbieosKeyBatchTests: XCTestCase {
+
+    let abi = """
+    {"version":"eosio::abi/1.1","structs":[{"name":"empty","base":"","fields":[]},{"name":"pair","base":"","fields":[{"name":"a","type":"uint32"},{"name":"b","type":"string"}]}]}
+    """
+
+    var context: OpaquePointer?
+
+    override func setUp() {
+        super.setUp()
+        context = abieos_create()
+        XCTAssertEqual(abieos_set_abi(context, 1, abi), 1)
+    }
+
+    override func tearDown() {
+        abieos_destroy(context)
+        context = nil
+        super.tearDown()
+    }
+
+    private func keyBatch(type: String, data: [UInt8]) -> abieos_bool {
+        return data.withUnsafeBufferPointer { buffer in
+            buffer.withMemoryRebound(to: CChar.self) { abieos_bin_to_key_batch(context, 1, type, $0.baseAddress, $0.count) }
+        }
+    }
+
+    func testBatch() {
+        let data: [UInt8] = [0x01, 0x00, 0x00, 0x00, 0x02, 0x68, 0x69, 0xff, 0x00, 0x00, 0x00, 0x00]
+        XCTAssertEqual(keyBatch(type: "pair", data: data), 1)
+        XCTAssertEqual(String(cString: abieos_get_bin_hex(context)), "0208000000016869000006000000FF0000")
+    }
+
+    func testEmptyInput() {
+        XCTAssertEqual(keyBatch(type: "empty", data: []), 1)
+        XCTAssertEqual(String(cString: abieos_get_bin_hex(context)), "00")
+    }
+
+    func testZeroSizeTypeIsRejected() {
+        XCTAssertEqual(keyBatch(type: "empty", data: [0x00]), 0)
+        XCTAssertEqual(String(cString: abieos_get_error(context)), "type \"empty\" has an empty binary form")
+    }
+
+    func testTruncatedValue() {
+        XCTAssertEqual(keyBatch(type: "pair", data: [0x01, 0x00, 0x00]), 0)
+        XCTAssertEqual(String(cString: abieos_get_error(context)), "Stream overrun")
+    }
+
+}
@@ -0,0 +1,135 @@
+//
+//  EosioAbieosNameSlotsTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+class EosioAbieosNameSlotsTests: XCTestCase {
+
+    let slotSize = 13
+    let charmap = Array(".12345abcdefghijklmnopqrstuvwxyz".utf8)
+
+    var context: OpaquePointer?
+    var seed: UInt64 = 1
+
+    override func setUp() {
+        super.setUp()
+        context = abieos_create()
+        seed = 1
+    }
+
+    override func tearDown() {
+        abieos_destroy(context)
+        context = nil
+        super.tearDown()
+    }
+
+    /// splitmix64
+    private func random() -> UInt64 {
+        seed = seed &+ 0x9e3779b97f4a7c15
+        var z = seed
+        z = (z ^ (z >> 30)) &* 0xbf58476d1ce4e5b9
+        z = (z ^ (z >> 27)) &* 0x94d049bb133111eb
+        return z ^ (z >> 31)
+    }
+
+    /// name_to_string as it was before the conversion worked on whole words
+    private func referenceNameToString(_ name: UInt64) -> String {
+        var chars = [UInt8](repeating: UInt8(ascii: "."), count: slotSize)
+        var tmp = name
+        for i in 0..<slotSize {
+            chars[slotSize - 1 - i] = charmap[Int(tmp & (i == 0 ? 0x0f : 0x1f))]
+            tmp >>= (i == 0 ? 4 : 5)
+        }
+        while let last = chars.last, last == UInt8(ascii: ".") {
+            chars.removeLast()
+        }
+        return String(decoding: chars, as: UTF8.self)
+    }
+
+    /// Random names, names with trailing dots, and a few edge cases
+    private func names(count: Int) -> [UInt64] {
+        var names: [UInt64] = [0, 1, 0xf, 0x10, UInt64.max, UInt64.max << 4, UInt64.max << 59, 1 << 63]
+        for i in 0..<count {
+            var name = random()
+            if i % 2 == 1 {
+                // Clear the last 1 to 12 chars
+                let dots = UInt64(random() % 12 + 1)
+                name &= ~((1 << (4 + 5 * (dots - 1))) - 1)
+            }
+            names.append(name)
+        }
+        return names
+    }
+
+    private func slot(_ slots: [CChar], _ index: Int) -> [UInt8] {
+        let bytes = slots[index * slotSize..<(index + 1) * slotSize].map { UInt8(bitPattern: $0) }
+        return Array(bytes.prefix { $0 != 0 })
+    }
+
+    func testNamesToStringsMatchesReference() {
+        let names = self.names(count: 200_000)
+        var slots = [CChar](repeating: 1, count: names.count * slotSize)
+        abieos_names_to_strings(context, names, names.count, &slots)
+        for (i, name) in names.enumerated() {
+            let expected = referenceNameToString(name)
+            let bytes = slots[i * slotSize..<(i + 1) * slotSize].map { UInt8(bitPattern: $0) }
+            XCTAssertEqual(String(decoding: slot(slots, i), as: UTF8.self), expected, "\(name)")
+            XCTAssertTrue(bytes.dropFirst(expected.utf8.count).allSatisfy { $0 == 0 }, "\(name) padding")
+            if i % 100 == 0 {
+                XCTAssertEqual(String(cString: abieos_name_to_string(context, name)), expected, "\(name)")
+            }
+        }
+    }
+
+    func testSlotsRoundTrip() {
+        let names = self.names(count: 200_000)
+        var slots = [CChar](repeating: 0, count: names.count * slotSize)
+        abieos_names_to_strings(context, names, names.count, &slots)
+        var back = [UInt64](repeating: 0, count: names.count)
+        abieos_strings_to_names(context, slots, names.count, &back)
+        XCTAssertEqual(back, names)
+    }
+
+    func testStringsToNamesMatchesStringToName() {
+        // Chars which can be in a name, and some which can't
+        let chars = Array(".12345abcdefghijklmnopqrstuvwxyz".utf8) + Array("06789AZ{`~-_ ".utf8) + [0x7f, 0x80, 0xc3, 0xff]
+        var strings: [[UInt8]] = [Array("zzzzzzzzzzzzz".utf8), Array("a.b.c.d.e.f.g".utf8), Array("eosio.token".utf8), Array("............1".utf8), []]
+        for _ in 0..<200_000 {
+            let size = Int(random() % UInt64(slotSize + 1))
+            strings.append((0..<size).map { _ in chars[Int(random() % UInt64(chars.count))] })
+        }
+        var slots = [CChar](repeating: 0, count: strings.count * slotSize)
+        for (i, string) in strings.enumerated() {
+            for (j, c) in string.enumerated() {
+                slots[i * slotSize + j] = CChar(bitPattern: c)
+            }
+        }
+        var names = [UInt64](repeating: 0, count: strings.count)
+        abieos_strings_to_names(context, slots, strings.count, &names)
+        for (i, string) in strings.enumerated() {
+            let expected = (string.map { CChar(bitPattern: $0) } + [0]).withUnsafeBufferPointer { abieos_string_to_name(context, $0.baseAddress) }
+            XCTAssertEqual(names[i], expected, "\(string)")
+        }
+    }
+
+    func testNameEndsAtFirstNul() {
+        var slots = [CChar](repeating: 0, count: slotSize)
+        for (i, c) in "abc".utf8.enumerated() {
+            slots[i] = CChar(bitPattern: c)
+        }
+        slots[4] = CChar(bitPattern: UInt8(ascii: "z"))
+        var name: UInt64 = 0
+        abieos_strings_to_names(context, slots, 1, &name)
+        XCTAssertEqual(name, abieos_string_to_name(context, "abc"))
+    }
+
+}
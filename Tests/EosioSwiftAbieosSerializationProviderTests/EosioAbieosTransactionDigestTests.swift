@@ -0,0 +1,140 @@
+//
+//  EosioAbieosTransactionDigestTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+// swiftlint:disable line_length
+import Foundation
+import XCTest
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+class EosioAbieosTransactionDigestTests: XCTestCase {
+
+    let transactionAbi = """
+    {"version":"eosio::abi/1.0","types":[{"new_type_name":"account_name","type":"name"},{"new_type_name":"action_name","type":"name"},{"new_type_name":"permission_name","type":"name"}],"structs":[{"name":"permission_level","base":"","fields":[{"name":"actor","type":"account_name"},{"name":"permission","type":"permission_name"}]},{"name":"action","base":"","fields":[{"name":"account","type":"account_name"},{"name":"name","type":"action_name"},{"name":"authorization","type":"permission_level[]"},{"name":"data","type":"bytes"}]},{"name":"extension","base":"","fields":[{"name":"type","type":"uint16"},{"name":"data","type":"bytes"}]},{"name":"transaction_header","base":"","fields":[{"name":"expiration","type":"time_point_sec"},{"name":"ref_block_num","type":"uint16"},{"name":"ref_block_prefix","type":"uint32"},{"name":"max_net_usage_words","type":"varuint32"},{"name":"max_cpu_usage_ms","type":"uint8"},{"name":"delay_sec","type":"varuint32"}]},{"name":"transaction","base":"transaction_header","fields":[{"name":"context_free_actions","type":"action[]"},{"name":"actions","type":"action[]"},{"name":"transaction_extensions","type":"extension[]"}]}]}
+    """
+
+    let tokenAbi = """
+    {"version":"eosio::abi/1.1","structs":[{"name":"transfer","base":"","fields":[{"name":"from","type":"name"},{"name":"to","type":"name"},{"name":"quantity","type":"asset"},{"name":"memo","type":"string"}]}],"actions":[{"name":"transfer","type":"transfer","ricardian_contract":""}]}
+    """
+
+    let multiAbi = """
+    {"version":"eosio::abi/1.1","structs":[{"name":"multi","base":"","fields":[{"name":"account","type":"name"},{"name":"name","type":"name"},{"name":"data","type":"bytes[]"}]}]}
+    """
+
+    let hexData = "\"00AEAA4AC15CFD4500000060D234CD3DA06806000000000004454F53000000001A746865206772617373686F70706572206C696573206865617679\""
+
+    let objectData = """
+    {"from":"cryptkeeper","to":"brandon","quantity":"42.0000 EOS","memo":"the grasshopper lies heavy"}
+    """
+
+    let hex = "1686755CA99DE8E73E12000000000100A6823403EA3055000000572D3CCDCD0100AEAA4AC15CFD4500000000A8ED32323B00AEAA4AC15CFD4500000060D234CD3DA06806000000000004454F53000000001A746865206772617373686F70706572206C69657320686561767900"
+
+    let chainId = "aca376f206b8fc25a6ed44dbdc66547c36c6c33e3a119ffbeaef943642f0e906"
+
+    var context: OpaquePointer?
+
+    override func setUp() {
+        super.setUp()
+        context = abieos_create()
+        XCTAssertEqual(abieos_set_abi(context, 0, transactionAbi), 1)
+        XCTAssertEqual(abieos_set_abi(context, abieos_string_to_name(context, "eosio.token"), tokenAbi), 1)
+        XCTAssertEqual(abieos_set_abi(context, 2, multiAbi), 1)
+    }
+
+    override func tearDown() {
+        abieos_destroy(context)
+        context = nil
+        super.tearDown()
+    }
+
+    private func transaction(account: String = "eosio.token", name: String = "transfer", data: String) -> String {
+        return "{\"expiration\":\"2019-02-26T18:31:50.000\",\"ref_block_num\":40361,\"ref_block_prefix\":306112488,\"max_net_usage_words\":0,\"max_cpu_usage_ms\":0,\"delay_sec\":0,\"context_free_actions\":[],\"actions\":[{\"account\":\"\(account)\",\"name\":\"\(name)\",\"authorization\":[{\"actor\":\"cryptkeeper\",\"permission\":\"active\"}],\"data\":\(data)}],\"transaction_extensions\":[]}"
+    }
+
+    /// Returns the digest as hex, or nil with the error in abieos_get_error
+    private func digest(json: String, contract: UInt64 = 0, type: String = "transaction", contextFreeData: Data = Data()) -> String? {
+        guard let chainIdData = try? Data(hex: chainId) else {
+            XCTFail("Invalid chain id")
+            return nil
+        }
+
+        var digest = [CChar](repeating: 0, count: 32)
+        let result = chainIdData.withUnsafeBytes { (chainIdBytes: UnsafeRawBufferPointer) -> abieos_bool in
+            contextFreeData.withUnsafeBytes { (cfdBytes: UnsafeRawBufferPointer) -> abieos_bool in
+                abieos_transaction_json_to_bin(context, contract, type, json,
+                                               chainIdBytes.bindMemory(to: CChar.self).baseAddress,
+                                               cfdBytes.bindMemory(to: CChar.self).baseAddress, cfdBytes.count,
+                                               &digest)
+            }
+        }
+        guard result == 1 else {
+            return nil
+        }
+        return Data(digest.map { UInt8(bitPattern: $0) }).hexEncodedString()
+    }
+
+    private var error: String {
+        return String(cString: abieos_get_error(context))
+    }
+
+    private var bin: String {
+        return String(cString: abieos_get_bin_hex(context))
+    }
+
+    func testDigestWithoutContextFreeData() {
+        XCTAssertEqual(digest(json: transaction(data: hexData)), "8733e6d6610c005d70ec1b6aff9cff6458bf047ca07858e612d08cb5fa204e74")
+        XCTAssertEqual(bin, hex)
+    }
+
+    func testDigestWithContextFreeData() {
+        XCTAssertEqual(digest(json: transaction(data: hexData), contextFreeData: Data([0x01, 0x02, 0xab, 0xcd])), "1b7de8232e6b7fc0ade9e368c97562980e5175fdcdf2275afc71f0a68d1699e3")
+        XCTAssertEqual(bin, hex)
+    }
+
+    func testObjectDataMatchesHexData() {
+        XCTAssertEqual(digest(json: transaction(data: objectData)), "8733e6d6610c005d70ec1b6aff9cff6458bf047ca07858e612d08cb5fa204e74")
+        XCTAssertEqual(bin, hex)
+    }
+
+    func testLargeObjectDataHasMultiByteSize() {
+        let data = "{\"from\":\"cryptkeeper\",\"to\":\"brandon\",\"quantity\":\"42.0000 EOS\",\"memo\":\"\(String(repeating: "m", count: 200))\"}"
+        guard let dataHex = abieos_json_to_hex(context, abieos_string_to_name(context, "eosio.token"), "transfer", data) else {
+            XCTFail("Unable to convert action data: \(error)")
+            return
+        }
+        let hexDigest = digest(json: transaction(data: "\"\(String(cString: dataHex))\""))
+        XCTAssertEqual(hexDigest, "1168882b2addc6959495239442fa8c063a499fe2024ad456c4de5651a803c9a8")
+        let hexBin = bin
+
+        XCTAssertEqual(digest(json: transaction(data: data)), hexDigest)
+        XCTAssertEqual(bin, hexBin)
+        // 234 bytes of action data
+        XCTAssertTrue(bin.contains("A8ED3232EA01"))
+    }
+
+    func testContractNotLoaded() {
+        XCTAssertNil(digest(json: transaction(account: "nobody", data: objectData)))
+        XCTAssertEqual(error, "contract \"nobody\" is not loaded")
+    }
+
+    func testActionNotInContract() {
+        XCTAssertNil(digest(json: transaction(name: "nothing", data: objectData)))
+        XCTAssertEqual(error, "contract \"eosio.token\" does not have action \"nothing\"")
+    }
+
+    func testBytesArrayElementIsNotAnAction() {
+        let json = "{\"account\":\"eosio.token\",\"name\":\"transfer\",\"data\":[\(objectData)]}"
+        XCTAssertNil(digest(json: json, contract: 2, type: "multi"))
+        XCTAssertEqual(error, "Expected string")
+
+        XCTAssertEqual(digest(json: "{\"account\":\"eosio.token\",\"name\":\"transfer\",\"data\":[\"00ff\"]}", contract: 2, type: "multi"), "f27c1cec1446c3c150d73e27a1d7c54c85c7dc68df7ee192456b602b468cfc54")
+        XCTAssertEqual(bin, "00A6823403EA3055000000572D3CCDCD010200FF")
+    }
+
+}
@@ -0,0 +1,169 @@
+//
+//  EosioAbieosTranscodeTests.swift
+//  EosioSwiftAbieosTests
+//
+// Copyright (c) 2017-2019 block.one and its contributors. All rights reserved.
+//
+
+// swiftlint:disable line_length
+import Foundation
+import XCTest
+import EosioSwift
+#if SWIFT_PACKAGE
+import Abieos
+#endif
+
+class EosioAbieosTranscodeTests: XCTestCase {
+
+    let v1 = """
+    [{"name":"s","base":"","fields":[{"name":"a","type":"uint32"},{"name":"b","type":"string"}]}]
+    """
+
+    let value = """
+    {"a":7,"b":"hi"}
+    """
+
+    var context: OpaquePointer?
+    var nextContract: UInt64 = 1
+
+    override func setUp() {
+        super.setUp()
+        context = abieos_create()
+    }
+
+    override func tearDown() {
+        abieos_destroy(context)
+        context = nil
+        super.tearDown()
+    }
+
+    private var error: String {
+        return "error: " + String(cString: abieos_get_error(context))
+    }
+
+    private func abi(structs: String, variants: String) -> String {
+        return "{\"version\":\"eosio::abi/1.1\",\"structs\":\(structs),\"variants\":\(variants)}"
+    }
+
+    /// Converts json to binary in the old abi, transcodes it to the new one and returns the hex and json of the result,
+    /// or the error
+    private func transcode(from: String, to: String, type: String = "s", json: String, fromVariants: String = "[]", toVariants: String = "[]") -> String {
+        let fromContract = nextContract
+        let toContract = nextContract + 1
+        nextContract += 2
+        guard abieos_set_abi(context, fromContract, abi(structs: from, variants: fromVariants)) == 1,
+              abieos_set_abi(context, toContract, abi(structs: to, variants: toVariants)) == 1,
+              abieos_json_to_bin(context, fromContract, type, json) == 1,
+              let binData = abieos_get_bin_data(context) else {
+            XCTFail(error)
+            return error
+        }
+        let bin = Data(bytes: binData, count: Int(abieos_get_bin_size(context)))
+        let result = bin.withUnsafeBytes { (bytes: UnsafeRawBufferPointer) -> abieos_bool in
+            abieos_transcode_bin(context, fromContract, type, toContract, type, bytes.bindMemory(to: CChar.self).baseAddress, bytes.count)
+        }
+        guard result == 1 else {
+            return error
+        }
+        let hex = String(cString: abieos_get_bin_hex(context))
+        guard let newJson = abieos_hex_to_json(context, toContract, type, hex) else {
+            return error
+        }
+        return hex + " " + String(cString: newJson)
+    }
+
+    func testAddedOptional() {
+        let v2 = """
+        [{"name":"s","base":"","fields":[{"name":"a","type":"uint32"},{"name":"n","type":"uint8?"},{"name":"b","type":"string"}]}]
+        """
+        XCTAssertEqual(transcode(from: v1, to: v2, json: value), "0700000000026869 {\"a\":7,\"n\":null,\"b\":\"hi\"}")
+    }
+
+    func testAddedTrailingExtension() {
+        let v2 = """
+        [{"name":"s","base":"","fields":[{"name":"a","type":"uint32"},{"name":"b","type":"string"},{"name":"e","type":"uint64$"}]}]
+        """
+        XCTAssertEqual(transcode(from: v1, to: v2, json: value), "07000000026869 {\"a\":7,\"b\":\"hi\"}")
+    }
+
+    func testAbsentExtensionStaysAbsent() {
+        let from = """
+        [{"name":"s","base":"","fields":[{"name":"a","type":"uint32"},{"name":"e","type":"uint64$"}]}]
+        """
+        let to = """
+        [{"name":"s","base":"","fields":[{"name":"a","type":"uint32"},{"name":"n","type":"uint8?"},{"name":"e","type":"uint64$"},{"name":"f","type":"string$"}]}]
+        """
+        XCTAssertEqual(transcode(from: from, to: to, json: "{\"a\":7}"), "0700000000 {\"a\":7,\"n\":null}")
+    }
+
+    func testRemovedField() {
+        let v2 = """
+        [{"name":"s","base":"","fields":[{"name":"b","type":"string"}]}]
+        """
+        XCTAssertEqual(transcode(from: v1, to: v2, json: value), "026869 {\"b\":\"hi\"}")
+    }
+
+    func testFieldBecomesOptional() {
+        let v2 = """
+        [{"name":"s","base":"","fields":[{"name":"a","type":"uint32?"},{"name":"b","type":"string"}]}]
+        """
+        XCTAssertEqual(transcode(from: v1, to: v2, json: value), "0107000000026869 {\"a\":7,\"b\":\"hi\"}")
+    }
+
+    func testReorderedFieldsAreRejected() {
+        let v2 = """
+        [{"name":"s","base":"","fields":[{"name":"b","type":"string"},{"name":"a","type":"uint32"}]}]
+        """
+        XCTAssertEqual(transcode(from: v1, to: v2, json: value), "error: Types are not compatible")
+    }
+
+    func testChangedBuiltinTypeIsRejected() {
+        let v2 = """
+        [{"name":"s","base":"","fields":[{"name":"a","type":"uint64"},{"name":"b","type":"string"}]}]
+        """
+        XCTAssertEqual(transcode(from: v1, to: v2, json: value), "error: Types are not compatible")
+    }
+
+    func testAddedRequiredFieldIsRejected() {
+        let v2 = """
+        [{"name":"s","base":"","fields":[{"name":"a","type":"uint32"},{"name":"n","type":"uint8"},{"name":"b","type":"string"}]}]
+        """
+        XCTAssertEqual(transcode(from: v1, to: v2, json: value), "error: Types are not compatible")
+    }
+
+    func testRenamedFieldIsRejected() {
+        let v2 = """
+        [{"name":"s","base":"","fields":[{"name":"c","type":"uint32"},{"name":"b","type":"string"}]}]
+        """
+        XCTAssertEqual(transcode(from: v1, to: v2, json: value), "error: Types are not compatible")
+    }
+
+    func testVariantCaseMissingFromNewType() {
+        let structs = """
+        [{"name":"s","base":"","fields":[{"name":"v","type":"var"}]}]
+        """
+        let from = """
+        [{"name":"var","types":["uint8","string"]}]
+        """
+        let to = """
+        [{"name":"var","types":["string"]}]
+        """
+        XCTAssertEqual(transcode(from: structs, to: structs, json: "{\"v\":[\"uint8\",5]}", fromVariants: from, toVariants: to), "error: Variant case is missing from the new type")
+        XCTAssertEqual(transcode(from: structs, to: structs, json: "{\"v\":[\"string\",\"x\"]}", fromVariants: from, toVariants: to), "000178 {\"v\":[\"string\",\"x\"]}")
+    }
+
+    func testRecursiveType() {
+        let from = """
+        [{"name":"node","base":"","fields":[{"name":"value","type":"uint32"},{"name":"children","type":"node[]"}]}]
+        """
+        let to = """
+        [{"name":"node","base":"","fields":[{"name":"value","type":"uint32"},{"name":"label","type":"string?"},{"name":"children","type":"node[]"}]}]
+        """
+        let tree = """
+        {"value":1,"children":[{"value":2,"children":[]},{"value":3,"children":[{"value":4,"children":[]}]}]}
+        """
+        XCTAssertEqual(transcode(from: from, to: to, type: "node", json: tree), "010000000002020000000000030000000001040000000000 {\"value\":1,\"label\":null,\"children\":[{\"value\":2,\"label\":null,\"children\":[]},{\"value\":3,\"label\":null,\"children\":[{\"value\":4,\"label\":null,\"children\":[]}]}]}")
+        XCTAssertEqual(transcode(from: from, to: from, type: "node", json: tree), "0100000002020000000003000000010400000000 \(tree)")
+    }
+
+}
@@ -0,0 +1,135 @@
+// Builds and verifies abi snapshots (see abieos_save_snapshot and abieos_load_snapshot in abieos.h).
+//
+// Build:
+//    cc -O3 -c Sources/Abieos/eosio/fpconv.c -o fpconv.o
+//    c++ -std=gnu++17 -O3 -I Sources/Abieos -I Sources/Abieos/include Tools/abieos_snapshot.cpp Sources/Abieos/abi.cpp Sources/Abieos/abieos.cpp Sources/Abieos/crypto.cpp fpconv.o -o abieos_snapshot -pthread
+//
+// Usage:
+//    abieos_snapshot build <snapshot> <contract>=<abi> ...
+//    abieos_snapshot verify <snapshot> [<contract>=<abi> ...]
+//
+// An <abi> file is in JSON format if its name ends in .json, and in binary format otherwise. verify checks that the
+// snapshot loads and saves back to the same bytes. If abis are given, it also checks that the snapshot holds exactly
+// those contracts, with the types that abieos_set_abi gives them, and compares the load times.
+
+#include <abieos.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct context {
+    abieos_context* ctx = abieos_create();
+    ~context() { abieos_destroy(ctx); }
+    void check(bool ok) {
+        if (!ok)
+            throw std::runtime_error(abieos_get_error(ctx));
+    }
+    std::vector<char> bin() {
+        auto data = abieos_get_bin_data(ctx);
+        return {data, data + abieos_get_bin_size(ctx)};
+    }
+};
+
+std::vector<char> read_file(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+        throw std::runtime_error("can not open " + path);
+    return std::vector<char>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+struct abi_file {
+    std::string contract;
+    std::string path;
+    bool json = false;
+    std::vector<char> data;
+};
+
+std::vector<abi_file> read_abis(char** begin, char** end) {
+    std::vector<abi_file> result;
+    for (auto arg = begin; arg != end; ++arg) {
+        auto eq = strchr(*arg, '=');
+        if (!eq)
+            throw std::runtime_error(std::string("expected <contract>=<abi>: ") + *arg);
+        auto& a = result.emplace_back();
+        a.contract.assign(*arg, eq);
+        a.path = eq + 1;
+        a.data = read_file(a.path);
+        a.json = a.path.size() >= 5 && a.path.compare(a.path.size() - 5, 5, ".json") == 0;
+        if (a.json)
+            a.data.push_back(0);
+    }
+    return result;
+}
+
+double set_abis(context& c, const std::vector<abi_file>& abis) {
+    auto start = std::chrono::steady_clock::now();
+    for (auto& a : abis) {
+        auto contract = abieos_string_to_name(c.ctx, a.contract.c_str());
+        if (a.json)
+            c.check(abieos_set_abi(c.ctx, contract, a.data.data()));
+        else
+            c.check(abieos_set_abi_bin(c.ctx, contract, a.data.data(), a.data.size()));
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int build(const std::string& path, const std::vector<abi_file>& abis) {
+    context c;
+    set_abis(c, abis);
+    c.check(abieos_save_snapshot(c.ctx));
+    auto snapshot = c.bin();
+    std::ofstream(path, std::ios::binary).write(snapshot.data(), snapshot.size());
+    printf("%s: %zu contracts, %zu bytes\n", path.c_str(), abis.size(), snapshot.size());
+    return 0;
+}
+
+int verify(const std::string& path, const std::vector<abi_file>& abis) {
+    auto snapshot = read_file(path);
+    context loaded;
+    auto start = std::chrono::steady_clock::now();
+    loaded.check(abieos_load_snapshot(loaded.ctx, snapshot.data(), snapshot.size()));
+    double load_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    loaded.check(abieos_save_snapshot(loaded.ctx));
+    if (loaded.bin() != snapshot) {
+        fprintf(stderr, "%s: does not save back to the same bytes\n", path.c_str());
+        return 1;
+    }
+    printf("%s: ok, loaded in %.3f ms\n", path.c_str(), load_time * 1e3);
+    if (abis.empty())
+        return 0;
+
+    context parsed;
+    double set_time = set_abis(parsed, abis);
+    parsed.check(abieos_save_snapshot(parsed.ctx));
+    if (parsed.bin() != snapshot) {
+        fprintf(stderr, "%s: does not match the abis\n", path.c_str());
+        return 1;
+    }
+    printf("%s: matches %zu abis, which set in %.3f ms\n", path.c_str(), abis.size(), set_time * 1e3);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        if (argc >= 4 && !strcmp(argv[1], "build"))
+            return build(argv[2], read_abis(argv + 3, argv + argc));
+        if (argc >= 3 && !strcmp(argv[1], "verify"))
+            return verify(argv[2], read_abis(argv + 3, argv + argc));
+        fprintf(stderr,
+                "usage: %s build <snapshot> <contract>=<abi> ...\n       %s verify <snapshot> [<contract>=<abi> ...]\n",
+                argv[0], argv[0]);
+        return 1;
+    } catch (std::exception& e) {
+        fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+}